@@ -1,9 +1,15 @@
 #include "AbstractMovementPredictor.h"
 
-#include <boost/log/trivial.hpp>
 #include <boost/circular_buffer.hpp>
 #include <boost/lexical_cast.hpp>
 #include "Monitor.h"
+#include "RingTimeSeries.h"
+#include "TimeSeriesPyramid.h"
+#include "AsyncLog.h"
+#include "Clock.h"
+#include "Instrumentation.h"
+#include "Tracer.h"
+#include <algorithm>
 
 
 AbstractMovementPredictor::~AbstractMovementPredictor()
@@ -19,13 +25,32 @@ AbstractMovementPredictor::AbstractMovementPredictor(Sensor& sensor, std::chrono
     _shutdownRequested(false),
     _ms_to_predict(ms_to_predict),
     _ms_to_crossfade(ms_to_crossfade),
-    _transmissionDelay(transmissionDelay)
+    _transmissionDelay(transmissionDelay),
+    _wakeupSamples(20),
+    _maxWakeupInterval(std::chrono::milliseconds(50)),
+    _correlationSearchWindow(std::chrono::milliseconds(300)),
+    _correlationSearchMethod(CorrelationSearch::Exhaustive),
+    _cycleArena(256 * 1024)
 {
 }
 
+void AbstractMovementPredictor::setWakeup(size_t samples, std::chrono::milliseconds maxInterval)
+{
+    _wakeupSamples = samples;
+    _maxWakeupInterval = maxInterval;
+}
+
+void AbstractMovementPredictor::setCorrelationSearch(std::chrono::milliseconds windowExtension, size_t threads, CorrelationSearch method)
+{
+    _correlationSearchWindow = windowExtension;
+    _correlationSearchMethod = method;
+    _correlationSearchPool.reset(threads > 1 ? new ThreadPool(threads) : nullptr);
+}
+
 void AbstractMovementPredictor::predictMovement(Sensor::Queue& inbound, ConsumeFunction consume, std::function<void(const std::string, TimeSeries&)> monitor)
 {
-    _predictThread = std::thread([this, &inbound, consume, monitor]() {
+    _predictThread = std::thread([this, &inbound, consume, monitor, participant = Clock::Participant()]() {
+        participant.enter();
         predictMovementThread(inbound, consume, monitor);
         });
 
@@ -34,8 +59,13 @@ void AbstractMovementPredictor::predictMovement(Sensor::Queue& inbound, ConsumeF
 
 void AbstractMovementPredictor::predictMovementThread(Sensor::Queue& inbound, ConsumeFunction consume, std::function<void(const std::string, TimeSeries&)> monitor)
 {
-    TimeSeries inbound_ts;
-    TimeSeries curPrediction;
+    Tracer::setThreadName("predictor");
+    // at most one sample per ms after deduplication, plus some headroom for the samples arriving during a cycle
+    RingTimeSeries inbound_ts((size_t)(inboundWindowPeriods * maxPeriodicity.count()) + 4096);
+    TimeSeries received;
+    UniformTimeSeries resampled_inbound;
+    PhaseModel curPrediction;
+    std::chrono::milliseconds curRotationOffset(0); // offset the current model was extended with
 
     boost::circular_buffer<std::chrono::milliseconds> periodicity_buf(5);
 
@@ -44,24 +74,31 @@ void AbstractMovementPredictor::predictMovementThread(Sensor::Queue& inbound, Co
     //TimeSeries curNewPredictionSlice;
 
 
+    inbound.setWakeup(_wakeupSamples, wakeupEvent());
+
     while (!_shutdownRequested)
     {
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        // run as soon as enough new data is there, the max interval keeps the loop going if the sensor stalls
+        inbound.waitForSamples(_maxWakeupInterval);
+        Instrumentation::predictor.recordQueueDepth(inbound.read_available());
+        Instrumentation::LoopTimer loopTimer(Instrumentation::predictor);
+        Tracer::Scope trace("cycle");
+        _cycleArena.reset();
+        // compute time of the cycle, always real time
         auto ts_pred_begin = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now());
 
 
-        // copy from queue into local time series
-        inbound.consume_all([&inbound_ts](const TimeSeries::Sample& sample)
+        // copy from queue into local time series, duplicate timestamps are replaced by the ring
+        received.clear();
+        inbound.consume_all([&inbound_ts, &received](const TimeSeries::Sample& sample)
             {
                 inbound_ts.add(sample);
+                received.add(sample);
             });
-        monitor("raw", inbound_ts);
-        inbound_ts.deduplicate();
-        //assert(inbound_ts.checkConsistency());
+        monitor("raw", received);
 
-        // resample to evently spaced 1 ms
-        TimeSeries resampled_inbound = inbound_ts.resample();
-        resampled_inbound.deduplicate();
+        // resample to evently spaced 1 ms, only the samples received since the last cycle are processed
+        inbound_ts.resampleIncremental(resampled_inbound);
         //assert(resampled_inbound.checkConsistency());
 
         // calc and check periodicity (after resampling for better accuracy)
@@ -70,18 +107,18 @@ void AbstractMovementPredictor::predictMovementThread(Sensor::Queue& inbound, Co
         if (sinePeriodTuple)
             periodicity = std::get<0>(*sinePeriodTuple);
 
-        //BOOST_LOG_TRIVIAL(info) << "inbound queue size" <<  inbound_ts.getVector().size() <<  std::endl;
+        //BOOST_LOG_TRIVIAL(info) << "inbound queue size" <<  inbound_ts.size() <<  std::endl;
 
         if (!periodicity)
         {
-            BOOST_LOG_TRIVIAL(info) << "not enough data to predict" << std::endl;
+            AsyncLog::info("not enough data to predict");
             continue;
         }
 
 
-        if (*periodicity < std::chrono::seconds(1) || *periodicity > std::chrono::seconds(30))
+        if (*periodicity < minPeriodicity || *periodicity > maxPeriodicity)
         {
-            BOOST_LOG_TRIVIAL(info) << "periodicity out of range: " << periodicity->count() << std::endl;
+            AsyncLog::info("periodicity out of range: {}", periodicity->count());
         }
         else
         {
@@ -91,7 +128,7 @@ void AbstractMovementPredictor::predictMovementThread(Sensor::Queue& inbound, Co
             continue;
 
         // Calculate median
-        std::vector<std::chrono::milliseconds> sorted_elements(periodicity_buf.begin(), periodicity_buf.end());
+        std::pmr::vector<std::chrono::milliseconds> sorted_elements(periodicity_buf.begin(), periodicity_buf.end(), &_cycleArena);
         std::sort(sorted_elements.begin(), sorted_elements.end());
         std::chrono::milliseconds median;
         size_t size = sorted_elements.size();
@@ -103,111 +140,75 @@ void AbstractMovementPredictor::predictMovementThread(Sensor::Queue& inbound, Co
 
 
         // reduce original inbound buffer to 2.1 cylcles
-        inbound_ts = inbound_ts.slice(std::get<1>(inbound_ts.getVector().back()) - std::chrono::milliseconds((int)(2.1 * median_period.count())), std::get<1>(inbound_ts.getVector().back()));
-        //assert(inbound_ts.checkConsistency());
+        inbound_ts.dropBefore(inbound_ts.time(inbound_ts.size() - 1) - std::chrono::milliseconds((int)(inboundWindowPeriods * median_period.count())));
 
         auto resultExtend = extendOnPeriodicyity(resampled_inbound, median_period);
-        TimeSeries newPredictionUnfiltered = std::get<0>(resultExtend);
-        TimeSeries newPrediction = newPredictionUnfiltered; // newPredictionUnfiltered.filter(50, 2);
-        //assert(newPrediction.checkConsistency());
-
+        PhaseModel& newPrediction = std::get<0>(resultExtend);
 
-        if (curPrediction.getVector().size() == 0)
+        if (!newPrediction.empty())
         {
-            curPrediction = newPrediction;
+            if (!curPrediction.empty())
+            {
+                // in the renderer we are currently reading the data from time stamp Now() + transmissionDelay
+                // hence until this point we want the old model, cross fade from that point on into the new model to avoid jumps
+                auto refNow = Clock::now();
+                auto currentConsumerPos = refNow + _transmissionDelay;
+                newPrediction.crossFadeFrom(curPrediction, currentConsumerPos, _ms_to_crossfade);
+            }
+            curPrediction = std::move(newPrediction);
+            curRotationOffset = std::get<1>(resultExtend);
         }
-        else
-        {
-            // in the renderer we are currently reading the data from time stamp Now() + transmissionDelay
-            // hence until this point we want the old data, cross fade from that point on into the new data to avoid jumps
-
-            auto refNow = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now());
-            auto currentConsumerPos = refNow + _transmissionDelay;
-
-            //BOOST_LOG_TRIVIAL(info) << "cur pred beg: " << std::chrono::steady_clock::to_time_t(std::get<1>(curPrediction.getVector().front();
-            // keep the last 200 ms for potential overlaps. Can be increased for debugging
-            // 
-            //BOOST_LOG_TRIVIAL(info) << "cur pred beg: " << std::get<1>(curPrediction.getVector().front()) << " cur pred end: " << std::get<1>(curPrediction.getVector().back())
-            //                        << "new pred beg: " << std::get<1>(newPrediction.getVector().front()) << " new pred end: " << std::get<1>(newPrediction.getVector().back()) << std::endl;
-
-            //BOOST_LOG_TRIVIAL(info) << "cur pred duration: " << curPrediction.duration().count() << " new pred duration: " << newPrediction.duration().count();
-            TimeSeries slicedOldPred = curPrediction.slice(refNow - std::chrono::milliseconds(200), currentConsumerPos + _ms_to_crossfade);
-            TimeSeries slicedNewPred = newPrediction.slice(currentConsumerPos, currentConsumerPos + _ms_to_crossfade + _ms_to_predict);
-
 
-            curPrediction = slicedOldPred.crossFade(slicedNewPred);
-
-            //BOOST_LOG_TRIVIAL(info) << "cross faded beg: " << std::get<1>(curPrediction.getVector().front()) << " cross faded end: " << std::get<1>(curPrediction.getVector().back())   <<  std::endl;
-            //BOOST_LOG_TRIVIAL(info) << "cross faded duration: " << curPrediction.duration().count();
-            //assert(curPrediction.checkConsistency());
-            //assert(old.checkConsistency());
-
-            //monitor("old prediction", old);
-            //monitor("new prediction", newPrediction);
-
-
-            consume(curPrediction, median_period, std::get<1>(*sinePeriodTuple), std::get<1>(resultExtend), ""); // no overlay in non-calibration mode
-        }
+        // the renderer divides by the period minus the offset, which the median period can have moved below
+        if (!curPrediction.empty() && curRotationOffset < median_period)
+            consume(curPrediction, median_period, std::get<1>(*sinePeriodTuple), curRotationOffset, ""); // no overlay in non-calibration mode
 
         auto ts_pred_end = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now());
 
-        BOOST_LOG_TRIVIAL(info) << "prediction time: " << std::chrono::duration_cast<std::chrono::milliseconds>(ts_pred_end - ts_pred_begin).count() << std::endl;
+        AsyncLog::info("prediction time: {}", std::chrono::duration_cast<std::chrono::milliseconds>(ts_pred_end - ts_pred_begin).count());
 
     }
 }
 
 int fileNum = 0;
 
-std::tuple<TimeSeries, std::chrono::milliseconds>  AbstractMovementPredictor::extendOnPeriodicyity(TimeSeries& ts, std::chrono::milliseconds periodicity)
+std::tuple<PhaseModel, std::chrono::milliseconds>  AbstractMovementPredictor::extendOnPeriodicyity(const TimeSeriesView& ts, std::chrono::milliseconds periodicity)
 {
-    TimeSeries overlappingPreidction;
-    TimeSeries crossFadedResult;
-
     const auto  correlationTimeSeriesLength = std::chrono::milliseconds(500);
-    const auto  correlationSearchWindowSize = std::chrono::milliseconds(300);
 
-    TimeSeries latestSamples = ts.slice(std::get<1>(ts.getVector().back()) - correlationTimeSeriesLength, std::get<1>(ts.getVector().back()));
-    latestSamples.shift(-periodicity);
+    // the latest samples, moved back by one period
+    TimeSeriesView latestSamples = ts.slice(ts.time(ts.size() - 1) - correlationTimeSeriesLength, ts.time(ts.size() - 1));
 
-    auto bestOffset = ts.bestMatch(correlationSearchWindowSize, latestSamples);
+    // an offset of a period or more would compare the latest samples with themselves
+    auto searchWindow = std::clamp(periodicity - correlationTimeSeriesLength - std::chrono::milliseconds(1), std::chrono::milliseconds(0), _correlationSearchWindow);
 
-    BOOST_LOG_TRIVIAL(info) << "current rotation offset: " << bestOffset.count() << std::endl;
+    std::chrono::milliseconds bestOffset;
+    if (_correlationSearchMethod == CorrelationSearch::Pyramid)
+        bestOffset = TimeSeriesPyramid(ts, { 1, 4, 16 }, &_cycleArena).bestMatch(searchWindow, TimeSeriesPyramid(latestSamples, { 1, 4, 16 }, &_cycleArena), -periodicity);
+    else
+        bestOffset = ts.bestMatch(searchWindow, latestSamples, -periodicity, _correlationEngine, _correlationSearchPool.get());
+
+    AsyncLog::info("current rotation offset: {}", bestOffset.count());
 
 #if 0
     std::string file_name = "match_" + boost::lexical_cast<std::string>(bestOffset.count()) + "_num_" + boost::lexical_cast<std::string>(fileNum++);
     std::map<std::string, TimeSeries> data;
-    data["timeseries"] = ts.slice(std::get<1>(latestSamples.getVector().front()), std::get<1>(latestSamples.getVector().back()));
-    data["latestSamples"] = latestSamples;
+    data["timeseries"] = TimeSeries(ts.slice(latestSamples.time(0) - periodicity, latestSamples.time(latestSamples.size() - 1) - periodicity));
+    data["latestSamples"] = TimeSeries(latestSamples);
+    data["latestSamples"].shift(-periodicity);
     Monitor::plot(file_name, data);
 #endif
 
 
-    auto sourceInd = ts.findIndex(std::get<1>(ts.getVector().back()) - _ms_to_crossfade - periodicity + bestOffset);
-    if (!sourceInd)
+    // the effective period is the median period corrected by the best match, the last such period of data is continued
+    auto cycleLength = periodicity - bestOffset;
+    if (cycleLength.count() <= 0 || ts.duration() < cycleLength)
     {
-        BOOST_LOG_TRIVIAL(info) << "source index not found. TS too short" << std::endl;
-        return { TimeSeries(), bestOffset };
+        AsyncLog::info("not enough data for one cycle. TS too short");
+        return { PhaseModel(), bestOffset };
     }
 
-    if (periodicity <= _ms_to_predict + _ms_to_crossfade)
-    {
-        BOOST_LOG_TRIVIAL(info) << "periodicity must be longer than prediction + crossfade" << std::endl;
-        return { TimeSeries(), bestOffset };
-    }
-
-    auto startInd = ts.findIndex(std::get<1>(ts.getVector().back()) - _ms_to_crossfade);
-    auto predict_start_time = std::get<1>(ts.getVector()[*startInd]);
-    for (int i = 0; i < (_ms_to_crossfade + _ms_to_predict).count(); i++) // predict cross fade ms of the already exisiiting data to allow for a smooth cross fade
-    {
-        overlappingPreidction.getVector().push_back({ std::get<0>(ts.getVector()[*sourceInd + i]), predict_start_time + std::chrono::milliseconds(i), 0 });
-    }
-
-    //assert(overlappingPreidction.checkConsistency());
-
-    crossFadedResult = ts.crossFade(overlappingPreidction);
-    //assert(crossFadedResult.checkConsistency());
-    return { crossFadedResult, bestOffset };
-
+    return { PhaseModel(ts.slice(ts.time(ts.size() - 1) - cycleLength, ts.time(ts.size() - 1))), bestOffset };
 }
 
 
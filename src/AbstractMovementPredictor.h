@@ -2,6 +2,11 @@
 
 #include <atomic>
 #include "Sensor.h"
+#include "CorrelationEngine.h"
+#include "PhaseModel.h"
+#include "ThreadPool.h"
+#include "CycleArena.h"
+#include <memory>
 #include <thread>
 #include <atomic>
 #include <thread>
@@ -10,27 +15,53 @@
 class AbstractMovementPredictor
 {
 public:
-	typedef std::function<void(TimeSeries&, std::chrono::milliseconds, TimeSeries::Timestamp, std::chrono::milliseconds,  const std::string&) > ConsumeFunction;
+	enum class CorrelationSearch
+	{
+		Exhaustive, // every offset at full resolution
+		Pyramid // coarse to fine over a 1, 4 and 16 ms pyramid
+	};
+
+	typedef std::function<void(const PhaseModel&, std::chrono::milliseconds, TimeSeries::Timestamp, std::chrono::milliseconds,  const std::string&) > ConsumeFunction;
 	AbstractMovementPredictor(Sensor& sensor, std::chrono::milliseconds ms_to_predict,
 		std::chrono::milliseconds ms_to_crossfade, std::chrono::milliseconds transmissionDelay);
 	virtual ~AbstractMovementPredictor();
 	virtual void predictMovement(Sensor::Queue& inbound, ConsumeFunction f, std::function<void(const std::string, TimeSeries&)> monitor);
 	virtual void shutdown();
+	// the prediction runs after every samples new samples or a period event, but at least every maxInterval
+	void setWakeup(size_t samples, std::chrono::milliseconds maxInterval);
+	// offsets searched around the last period when matching the latest samples, an exhaustive search is spread over threads if more than one
+	void setCorrelationSearch(std::chrono::milliseconds windowExtension, size_t threads, CorrelationSearch method = CorrelationSearch::Exhaustive);
+
+	// range of accepted periods and the number of periods of inbound data kept for prediction
+	static constexpr std::chrono::milliseconds minPeriodicity = std::chrono::seconds(1);
+	static constexpr std::chrono::milliseconds maxPeriodicity = std::chrono::seconds(30);
+	static constexpr double inboundWindowPeriods = 2.1;
 
 protected:
-	virtual std::optional<std::tuple<std::chrono::milliseconds, TimeSeries::Timestamp>> calcPeriodicity(TimeSeries& ts) = 0;
+	virtual std::optional<std::tuple<std::chrono::milliseconds, TimeSeries::Timestamp>> calcPeriodicity(const TimeSeriesView& ts) = 0;
+	virtual SampleQueue::WakeupEvent wakeupEvent() const
+	{
+		return SampleQueue::WakeupEvent::None;
+	}
 
 private:
 	void predictMovementThread(Sensor::Queue& inbound, ConsumeFunction consume, std::function<void(const std::string, TimeSeries&)> monitor);
-	std::tuple<TimeSeries, std::chrono::milliseconds> extendOnPeriodicyity(TimeSeries& ts, std::chrono::milliseconds periodicity);
+	std::tuple<PhaseModel, std::chrono::milliseconds> extendOnPeriodicyity(const TimeSeriesView& ts, std::chrono::milliseconds periodicity);
 
 protected:
 	Sensor& _sensor;
 	std::atomic<bool> _shutdownRequested;
 	std::thread _predictThread;
-	std::chrono::milliseconds _ms_to_predict;
+	std::chrono::milliseconds _ms_to_predict; // horizon the prediction is expected to be good for, the phase model itself can be evaluated at any time
 	std::chrono::milliseconds _ms_to_crossfade;
 	std::chrono::milliseconds _transmissionDelay;
+	size_t _wakeupSamples;
+	std::chrono::milliseconds _maxWakeupInterval;
+	CorrelationEngine _correlationEngine;
+	std::chrono::milliseconds _correlationSearchWindow;
+	std::unique_ptr<ThreadPool> _correlationSearchPool;
+	CorrelationSearch _correlationSearchMethod;
+	CycleArena _cycleArena; // temporaries of one prediction cycle
 
 };
 
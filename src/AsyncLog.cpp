@@ -0,0 +1,109 @@
+#include "AsyncLog.h"
+#include <boost/date_time/c_local_time_adjustor.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/log/attributes/constant.hpp>
+#include <boost/log/attributes/scoped_attribute.hpp>
+#include <boost/log/sources/record_ostream.hpp>
+#include <boost/log/sources/severity_logger.hpp>
+#include <boost/log/trivial.hpp>
+#include <sstream>
+
+
+boost::lockfree::queue<AsyncLog::Record, boost::lockfree::capacity<4096>> AsyncLog::_queue;
+std::atomic<bool> AsyncLog::_enabled(false);
+std::atomic<uint64_t> AsyncLog::_dropped(0);
+std::thread AsyncLog::_writerThread;
+std::mutex AsyncLog::_mutex;
+std::condition_variable AsyncLog::_cv;
+bool AsyncLog::_stopRequested = false;
+
+
+void AsyncLog::start()
+{
+    {
+        std::scoped_lock lock(_mutex);
+        _stopRequested = false;
+    }
+    _writerThread = std::thread([]() {
+        writerThread();
+        });
+    _enabled.store(true, std::memory_order_relaxed);
+}
+
+void AsyncLog::stop()
+{
+    if (!_writerThread.joinable())
+        return;
+
+    _enabled.store(false, std::memory_order_relaxed);
+    {
+        std::scoped_lock lock(_mutex);
+        _stopRequested = true;
+    }
+    _cv.notify_all();
+    _writerThread.join();
+}
+
+void AsyncLog::push(const Record& record)
+{
+    if (!_queue.bounded_push(record))
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string AsyncLog::format(const Record& record)
+{
+    std::ostringstream out;
+    size_t value = 0;
+    for (const char* c = record.message; *c; c++)
+    {
+        if (c[0] == '{' && c[1] == '}' && value < record.count)
+        {
+            const Value& v = record.values[value++];
+            if (v.isFloat)
+                out << v.floating;
+            else
+                out << v.integer;
+            c++;
+        }
+        else
+        {
+            out << *c;
+        }
+    }
+    return out.str();
+}
+
+/* polls the queue, the producers do not signal to stay lock-free */
+void AsyncLog::writerThread()
+{
+    boost::log::sources::severity_logger<boost::log::trivial::severity_level> logger;
+    uint64_t reportedDrops = 0;
+
+    std::unique_lock lock(_mutex);
+    while (true)
+    {
+        bool stop = _cv.wait_for(lock, std::chrono::milliseconds(20), [] { return _stopRequested; });
+        lock.unlock();
+
+        Record record;
+        while (_queue.pop(record))
+        {
+            // the time of the log call replaces the time of writing
+            auto utc = boost::posix_time::from_time_t(0) + boost::posix_time::microseconds(record.time);
+            auto local = boost::date_time::c_local_adjustor<boost::posix_time::ptime>::utc_to_local(utc);
+            BOOST_LOG_SCOPED_LOGGER_ATTR(logger, "TimeStamp", boost::log::attributes::constant<boost::posix_time::ptime>(local));
+            BOOST_LOG_SEV(logger, boost::log::trivial::info) << format(record);
+        }
+
+        uint64_t drops = dropped();
+        if (drops != reportedDrops)
+        {
+            BOOST_LOG_SEV(logger, boost::log::trivial::info) << "log queue full, dropped records: " << drops - reportedDrops;
+            reportedDrops = drops;
+        }
+
+        lock.lock();
+        if (stop)
+            break;
+    }
+}
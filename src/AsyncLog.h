@@ -0,0 +1,98 @@
+#pragma once
+
+#include <boost/lockfree/queue.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+/*
+* Logging for the real-time threads: a log call only stores the message literal, its numeric values and the time
+* in a fixed size record and pushes it to a lock-free queue, no formatting, allocation or I/O.
+* A background thread formats the records and hands them to Boost.Log, keeping the time of the log call.
+* If the queue is full the record is dropped and counted, the writer reports the count.
+* Until start() is called (--log=true) log calls return immediately.
+*/
+class AsyncLog
+{
+public:
+	static constexpr size_t maxValues = 4;
+
+	static void start();
+	// writes the remaining records
+	static void stop();
+
+	static bool enabled()
+	{
+		return _enabled.load(std::memory_order_relaxed);
+	}
+	static uint64_t dropped()
+	{
+		return _dropped.load(std::memory_order_relaxed);
+	}
+
+	// message: string literal, each {} is replaced by the next value
+	template <typename... Values>
+	static void info(const char* message, Values... values)
+	{
+		static_assert(sizeof...(Values) <= maxValues, "too many log values");
+		if (!enabled())
+			return;
+
+		Record record;
+		record.time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		record.message = message;
+		record.count = 0;
+		(record.add(values), ...);
+		push(record);
+	}
+
+private:
+	struct Value
+	{
+		bool isFloat;
+		union
+		{
+			int64_t integer;
+			double floating;
+		};
+	};
+
+	struct Record
+	{
+		int64_t time; // us since the epoch of the system clock
+		const char* message;
+		uint8_t count;
+		Value values[maxValues];
+
+		template <typename T>
+		void add(T value)
+		{
+			static_assert(std::is_arithmetic_v<T>, "only numeric log values");
+			Value& v = values[count++];
+			v.isFloat = std::is_floating_point_v<T>;
+			if constexpr (std::is_floating_point_v<T>)
+				v.floating = (double)value;
+			else
+				v.integer = (int64_t)value;
+		}
+	};
+
+	static void push(const Record& record);
+	static void writerThread();
+	static std::string format(const Record& record);
+
+private:
+	static boost::lockfree::queue<Record, boost::lockfree::capacity<4096>> _queue;
+	static std::atomic<bool> _enabled;
+	static std::atomic<uint64_t> _dropped;
+	static std::thread _writerThread;
+	static std::mutex _mutex;
+	static std::condition_variable _cv;
+	static bool _stopRequested;
+};
+
@@ -0,0 +1,88 @@
+#include "AutocorrelationPeriodEstimator.h"
+#include <algorithm>
+#include <cmath>
+
+
+AutocorrelationPeriodEstimator::AutocorrelationPeriodEstimator(std::chrono::milliseconds minPeriod, std::chrono::milliseconds maxPeriod, double threshold) :
+    _minLag(std::max<size_t>(minPeriod.count(), 2)),
+    _maxLag(maxPeriod.count()),
+    _threshold(threshold)
+{
+}
+
+std::optional<AutocorrelationPeriodEstimator::Period> AutocorrelationPeriodEstimator::estimate(const TimeSeriesView& ts)
+{
+    if (ts.empty())
+        return std::nullopt;
+
+    auto end = ts.time(ts.size() - 1);
+    if (!_lastPeriod && _lastAttempt && end >= *_lastAttempt && end - *_lastAttempt < retryInterval)
+        return std::nullopt;
+
+    // the longest lag needs 1.5 periods of signal, around the last estimate a few periods are enough
+    size_t window = _maxLag * 3 / 2;
+    if (_lastPeriod)
+        window = std::min(window, std::max<size_t>(windowPeriods * (size_t)std::ceil(_lastPeriod->count()), _minLag * 3 / 2 + 1));
+    auto x = ts.angles();
+    if (x.size() > window)
+        x = x.last(window);
+
+    _lastPeriod = estimateLatest(x);
+    _lastAttempt = end;
+    return _lastPeriod;
+}
+
+std::optional<AutocorrelationPeriodEstimator::Period> AutocorrelationPeriodEstimator::estimateLatest(std::span<const float> x)
+{
+    size_t n = x.size();
+
+    // each lag needs an overlap of at least half a period with the signal
+    size_t maxLag = std::min(_maxLag, n * 2 / 3);
+    if (maxLag <= _minLag)
+        return std::nullopt;
+
+    // _energy[i] = sum of x[j]^2 for j < i
+    _energy.resize(n + 1);
+    _energy[0] = 0.0;
+    for (size_t i = 0; i < n; i++)
+        _energy[i + 1] = _energy[i] + (double)x[i] * (double)x[i];
+
+    // one more lag than searched, the parabolic interpolation needs the right neighbour
+    _engine.slidingDotProducts(x.data(), n, x.data(), n, maxLag + 2, _autocorrelation);
+
+    // difference function per overlapping sample: sum of (x[j] - x[j + lag])^2 / (n - lag),
+    // cumulative mean normalized in place
+    _difference.resize(maxLag + 2);
+    _difference[0] = 1.0;
+    double sum = 0.0;
+    for (size_t lag = 1; lag < maxLag + 2; lag++)
+    {
+        double d = (_energy[n - lag] + _energy[n] - _energy[lag] - 2.0 * _autocorrelation[lag]) / (double)(n - lag);
+        d = std::max(d, 0.0);
+        sum += d;
+        _difference[lag] = sum > 0.0 ? d * (double)lag / sum : 1.0;
+    }
+
+    // minimum of the first dip below the threshold, noise can cause small local minima inside the dip
+    // and can push the flanks of the dip above the threshold for a few lags, so the dip only ends at twice the threshold
+    size_t begin = _minLag;
+    while (begin <= maxLag && _difference[begin] >= _threshold)
+        begin++;
+    if (begin > maxLag)
+        return std::nullopt;
+    size_t lag = begin;
+    for (size_t i = begin; i <= maxLag && _difference[i] < 2.0 * _threshold; i++)
+    {
+        if (_difference[i] < _difference[lag])
+            lag = i;
+    }
+
+    // parabola through the minimum and its neighbours for sub ms resolution
+    double left = _difference[lag - 1];
+    double center = _difference[lag];
+    double right = _difference[lag + 1];
+    double curvature = left - 2.0 * center + right;
+    double shift = curvature > 0.0 ? 0.5 * (left - right) / curvature : 0.0;
+
+    return Period((double)lag + std::clamp(shift, -0.5, 0.5));
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <vector>
+#include "TimeSeriesView.h"
+#include "CorrelationEngine.h"
+
+/*
+* YIN style period estimation on a signal resampled to 1 ms.
+* The difference function of all lags is computed from one autocorrelation (CorrelationEngine) and prefix sums of squares,
+* the period is the first dip of the cumulative mean normalized difference below the threshold, refined by parabolic interpolation.
+* Unlike zero crossings it uses the whole signal, so noise around a single level does not disturb the estimate.
+* Only the latest samples are analysed: 1.5 maximum periods, or a few of the last estimated periods once there is one,
+* so the cost does not grow with the history. Without an estimate, a failed attempt is only repeated after retryInterval.
+*/
+class AutocorrelationPeriodEstimator
+{
+public:
+	typedef std::chrono::duration<double, std::milli> Period;
+
+	AutocorrelationPeriodEstimator(std::chrono::milliseconds minPeriod, std::chrono::milliseconds maxPeriod, double threshold = 0.15);
+
+	static constexpr size_t windowPeriods = 3;
+	static constexpr std::chrono::milliseconds retryInterval = std::chrono::milliseconds(250);
+
+	// ts has to be evenly spaced with 1 ms, at least 1.5 periods are needed for an estimate
+	std::optional<Period> estimate(const TimeSeriesView& ts);
+
+private:
+	std::optional<Period> estimateLatest(std::span<const float> x);
+
+	size_t _minLag;
+	size_t _maxLag;
+	double _threshold;
+	std::optional<Period> _lastPeriod;
+	std::optional<TimeSeriesView::Timestamp> _lastAttempt; // end of the signal of the last attempt
+	CorrelationEngine _engine;
+	std::vector<double> _energy;
+	std::vector<double> _autocorrelation;
+	std::vector<double> _difference;
+};
+
@@ -0,0 +1,188 @@
+#include "Clock.h"
+#include <algorithm>
+#include <limits>
+#include <thread>
+#if defined(__linux__)
+#include <cerrno>
+#include <time.h>
+#endif
+
+
+Clock::Mode Clock::_mode = Clock::Mode::RealTime;
+double Clock::_speed = 1.0;
+std::chrono::steady_clock::time_point Clock::_realOrigin;
+Clock::Timestamp Clock::_origin;
+std::atomic<int64_t> Clock::_virtualNow(0);
+
+std::mutex Clock::_mutex;
+std::condition_variable Clock::_cv;
+int Clock::_participants = 0;
+int Clock::_nextParticipant = 0;
+std::vector<Clock::Waiter*> Clock::_waiters;
+thread_local int Clock::t_participant = -1;
+
+
+Clock::Participant::Participant() : _id(-1)
+{
+    if (_mode != Mode::Virtual)
+        return;
+
+    std::scoped_lock lock(_mutex);
+    _id = _nextParticipant++;
+    _participants++;
+}
+
+Clock::Participant::Participant(Participant&& other) noexcept : _id(other._id)
+{
+    other._id = -1;
+}
+
+Clock::Participant::~Participant()
+{
+    if (_id < 0)
+        return;
+
+    std::scoped_lock lock(_mutex);
+    _participants--;
+    // the remaining participants might all be waiting
+    schedule();
+}
+
+void Clock::Participant::enter() const
+{
+    t_participant = _id;
+}
+
+void Clock::setMode(Mode mode, double speed)
+{
+    _mode = mode;
+    _speed = speed > 0.0 ? speed : 1.0;
+    _realOrigin = std::chrono::steady_clock::now();
+    _origin = std::chrono::time_point_cast<std::chrono::milliseconds>(_realOrigin);
+    _virtualNow = _origin.time_since_epoch().count();
+    _waiters.reserve(16);
+}
+
+Clock::Timestamp Clock::now()
+{
+    switch (_mode)
+    {
+    case Mode::Accelerated:
+        return _origin + std::chrono::duration_cast<std::chrono::milliseconds>((std::chrono::steady_clock::now() - _realOrigin) * _speed);
+    case Mode::Virtual:
+        return Timestamp(std::chrono::milliseconds(_virtualNow.load(std::memory_order_acquire)));
+    default:
+        return std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now());
+    }
+}
+
+std::chrono::duration<double, std::milli> Clock::realDuration(std::chrono::milliseconds duration)
+{
+    if (_mode == Mode::Accelerated)
+        return duration / _speed;
+    return duration;
+}
+
+void Clock::sleepFor(std::chrono::milliseconds duration)
+{
+    if (_mode == Mode::Virtual && t_participant >= 0)
+    {
+        static const std::function<bool()> never = []() { return false; };
+        waitFor(duration, never);
+        return;
+    }
+    std::this_thread::sleep_for(realDuration(duration));
+}
+
+std::chrono::nanoseconds Clock::sleepUntil(Timestamp deadline, std::chrono::microseconds spin)
+{
+    if (_mode == Mode::Virtual && t_participant >= 0)
+    {
+        auto timeout = deadline - now();
+        if (timeout.count() > 0)
+            sleepFor(timeout);
+        return std::chrono::nanoseconds(0);
+    }
+
+    std::chrono::steady_clock::time_point realDeadline(deadline.time_since_epoch());
+    if (_mode == Mode::Accelerated)
+        realDeadline = _realOrigin + std::chrono::duration_cast<std::chrono::steady_clock::duration>(realDuration(deadline - _origin));
+
+    auto wakeup = realDeadline - spin;
+#if defined(__linux__)
+    // absolute sleep, no drift from the time between computing and starting a relative one (steady_clock is CLOCK_MONOTONIC)
+    auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(wakeup.time_since_epoch()).count();
+    timespec ts{ (time_t)(sinceEpoch / 1000000000), (long)(sinceEpoch % 1000000000) };
+    while (sinceEpoch > 0 && clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+    {
+    }
+#else
+    std::this_thread::sleep_until(wakeup);
+#endif
+
+    auto current = std::chrono::steady_clock::now();
+    while (current < realDeadline)
+        current = std::chrono::steady_clock::now();
+    return current - realDeadline;
+}
+
+bool Clock::waitFor(std::chrono::milliseconds timeout, const std::function<bool()>& predicate)
+{
+    std::unique_lock lock(_mutex);
+    if (_mode != Mode::Virtual || t_participant < 0)
+        return _cv.wait_for(lock, realDuration(timeout), predicate);
+
+    Waiter waiter{ t_participant, _virtualNow.load(std::memory_order_relaxed) + timeout.count(), &predicate, false, false };
+    _waiters.push_back(&waiter);
+    schedule();
+    _cv.wait(lock, [&waiter] { return waiter.granted; });
+    _waiters.erase(std::find(_waiters.begin(), _waiters.end(), &waiter));
+    return waiter.result;
+}
+
+void Clock::notify()
+{
+    {
+        std::scoped_lock lock(_mutex);
+    }
+    _cv.notify_all();
+}
+
+/* called with _mutex held: once all participants wait, resumes the first ready one, advancing the time if none is */
+void Clock::schedule()
+{
+    if (_participants == 0 || (int)_waiters.size() < _participants)
+        return;
+    if (std::any_of(_waiters.begin(), _waiters.end(), [](const Waiter* w) { return w->granted; }))
+        return;
+
+    while (true)
+    {
+        int64_t now = _virtualNow.load(std::memory_order_relaxed);
+        int64_t nextDeadline = std::numeric_limits<int64_t>::max();
+        Waiter* next = nullptr;
+        bool nextReady = false;
+        for (Waiter* waiter : _waiters)
+        {
+            nextDeadline = std::min(nextDeadline, waiter->deadline);
+            if (next && next->participant < waiter->participant)
+                continue;
+
+            bool ready = (*waiter->predicate)();
+            if (ready || waiter->deadline <= now)
+            {
+                next = waiter;
+                nextReady = ready;
+            }
+        }
+
+        if (next)
+        {
+            next->granted = true;
+            next->result = nextReady;
+            _cv.notify_all();
+            return;
+        }
+        _virtualNow.store(nextDeadline, std::memory_order_release);
+    }
+}
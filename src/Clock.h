@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/*
+* Time source of the pipeline. Sensors, predictors and renderers take the time and sleep through the Clock,
+* so recordings can be replayed faster than real time:
+* - RealTime: the steady clock
+* - Accelerated: runs speed times faster than the steady clock
+* - Virtual: time only advances when every participant thread waits in the Clock, then it jumps to the next deadline.
+*   Waiting participants are resumed one at a time in registration order, so a run is deterministic and as fast as the CPU allows.
+* The mode is set once before the pipeline threads start.
+*/
+class Clock
+{
+public:
+	typedef std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> Timestamp;
+
+	enum class Mode
+	{
+		RealTime,
+		Accelerated,
+		Virtual
+	};
+
+	/*
+	* A thread stepped by the virtual clock. Create it before the thread is started (so the clock cannot advance
+	* before the thread runs), move it into the thread and call enter() there. No-op in the other modes.
+	*/
+	class Participant
+	{
+	public:
+		Participant();
+		Participant(Participant&& other) noexcept;
+		Participant& operator=(Participant&&) = delete;
+		~Participant();
+
+		void enter() const;
+
+	private:
+		int _id; // -1 if not registered
+	};
+
+	static void setMode(Mode mode, double speed = 1.0);
+	static Mode mode()
+	{
+		return _mode;
+	}
+
+	static Timestamp now();
+	static void sleepFor(std::chrono::milliseconds duration);
+	// sleeps to an absolute deadline, the last spin of it busy waiting for sub-ms accuracy
+	// returns how late the deadline was met in real time, 0 in virtual mode
+	static std::chrono::nanoseconds sleepUntil(Timestamp deadline, std::chrono::microseconds spin = std::chrono::microseconds(0));
+	// waits until predicate() holds or timeout has passed, returns the predicate
+	// in virtual mode the predicate is evaluated by other threads as well, it may only read thread-safe state
+	static bool waitFor(std::chrono::milliseconds timeout, const std::function<bool()>& predicate);
+	// call after changing state a waitFor predicate depends on
+	static void notify();
+
+private:
+	struct Waiter
+	{
+		int participant;
+		int64_t deadline; // virtual ms
+		const std::function<bool()>* predicate;
+		bool granted;
+		bool result;
+	};
+
+	static void schedule();
+	static std::chrono::duration<double, std::milli> realDuration(std::chrono::milliseconds duration);
+
+private:
+	static Mode _mode;
+	static double _speed;
+	static std::chrono::steady_clock::time_point _realOrigin;
+	static Timestamp _origin;
+	static std::atomic<int64_t> _virtualNow; // ms since the epoch of the steady clock
+
+	static std::mutex _mutex;
+	static std::condition_variable _cv;
+	static int _participants;
+	static int _nextParticipant;
+	static std::vector<Waiter*> _waiters;
+	static thread_local int t_participant;
+};
+
@@ -0,0 +1,117 @@
+#include "CorrelationEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+
+void CorrelationEngine::slidingDotProducts(const float* signal, size_t signalSize, const float* pattern, size_t patternSize, size_t lags, std::vector<double>& result)
+{
+    result.assign(lags, 0.0);
+    if (lags == 0 || patternSize == 0 || signalSize == 0)
+        return;
+
+    // only the part of the signal that is touched by one of the lags matters
+    size_t usedSignal = std::min(signalSize, lags + patternSize - 1);
+
+    size_t fftSize = 1;
+    while (fftSize < usedSignal + patternSize - 1)
+        fftSize <<= 1;
+
+    // rough operation counts of both variants, the FFT one needs two transforms
+    double directCost = (double)lags * (double)patternSize;
+    double fftCost = 10.0 * (double)fftSize * std::log2((double)fftSize);
+
+    if (directCost <= fftCost)
+        directDotProducts(signal, usedSignal, pattern, patternSize, lags, result);
+    else
+        fftDotProducts(signal, usedSignal, pattern, patternSize, lags, result);
+}
+
+void CorrelationEngine::directDotProducts(const float* signal, size_t signalSize, const float* pattern, size_t patternSize, size_t lags, std::vector<double>& result)
+{
+    for (size_t s = 0; s < lags && s < signalSize; ++s)
+    {
+        size_t length = std::min(patternSize, signalSize - s);
+        double sum = 0.0;
+        for (size_t k = 0; k < length; ++k)
+            sum += (double)signal[s + k] * (double)pattern[k];
+        result[s] = sum;
+    }
+}
+
+/*
+* The dot products are a convolution of the signal with the reversed pattern.
+* Both real sequences are packed into one complex sequence (signal as real, reversed pattern as imaginary part),
+* so a single forward transform yields both spectra.
+*/
+void CorrelationEngine::fftDotProducts(const float* signal, size_t signalSize, const float* pattern, size_t patternSize, size_t lags, std::vector<double>& result)
+{
+    size_t n = 1;
+    while (n < signalSize + patternSize - 1)
+        n <<= 1;
+
+    _buffer.assign(n, std::complex<double>(0.0, 0.0));
+    for (size_t t = 0; t < signalSize; ++t)
+        _buffer[t].real(signal[t]);
+    for (size_t t = 0; t < patternSize; ++t)
+        _buffer[t].imag(pattern[patternSize - 1 - t]);
+
+    fft(_buffer, false);
+
+    // separate the two spectra and multiply them
+    _spectrum.resize(n);
+    for (size_t k = 0; k < n; ++k)
+    {
+        auto z = _buffer[k];
+        auto zMirror = std::conj(_buffer[(n - k) & (n - 1)]);
+        auto signalSpectrum = (z + zMirror) * 0.5;
+        auto patternSpectrum = (z - zMirror) * std::complex<double>(0.0, -0.5);
+        _spectrum[k] = signalSpectrum * patternSpectrum;
+    }
+
+    fft(_spectrum, true);
+
+    for (size_t s = 0; s < lags && s < signalSize; ++s)
+        result[s] = _spectrum[s + patternSize - 1].real() / (double)n;
+}
+
+/* iterative radix-2 FFT, the size of data must be a power of two */
+void CorrelationEngine::fft(std::vector<std::complex<double>>& data, bool inverse)
+{
+    size_t n = data.size();
+
+    if (_twiddles.size() != n / 2)
+    {
+        _twiddles.resize(n / 2);
+        for (size_t k = 0; k < n / 2; ++k)
+            _twiddles[k] = std::polar(1.0, -2.0 * std::numbers::pi * (double)k / (double)n);
+    }
+
+    // bit reversal permutation
+    for (size_t i = 1, j = 0; i < n; ++i)
+    {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(data[i], data[j]);
+    }
+
+    for (size_t len = 2; len <= n; len <<= 1)
+    {
+        size_t half = len / 2;
+        size_t step = n / len;
+        for (size_t i = 0; i < n; i += len)
+        {
+            for (size_t j = 0; j < half; ++j)
+            {
+                auto w = inverse ? std::conj(_twiddles[j * step]) : _twiddles[j * step];
+                auto u = data[i + j];
+                auto v = data[i + j + half] * w;
+                data[i + j] = u + v;
+                data[i + j + half] = u - v;
+            }
+        }
+    }
+}
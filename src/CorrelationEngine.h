@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+
+/*
+* Computes the sliding dot products of a pattern against a signal for a whole range of lags in one go.
+* Small problems are computed directly, larger ones via FFT in O(n log n).
+* The scratch buffers are kept between calls, so a long living engine does not allocate in steady state.
+*/
+class CorrelationEngine
+{
+public:
+	// result[s] = sum over k of signal[s + k] * pattern[k] for s in [0, lags), the signal is treated as zero beyond signalSize
+	void slidingDotProducts(const float* signal, size_t signalSize, const float* pattern, size_t patternSize, size_t lags, std::vector<double>& result);
+
+private:
+	void directDotProducts(const float* signal, size_t signalSize, const float* pattern, size_t patternSize, size_t lags, std::vector<double>& result);
+	void fftDotProducts(const float* signal, size_t signalSize, const float* pattern, size_t patternSize, size_t lags, std::vector<double>& result);
+	void fft(std::vector<std::complex<double>>& data, bool inverse);
+
+private:
+	std::vector<std::complex<double>> _buffer;
+	std::vector<std::complex<double>> _spectrum;
+	std::vector<std::complex<double>> _twiddles;
+};
+
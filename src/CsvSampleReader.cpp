@@ -0,0 +1,124 @@
+#include "CsvSampleReader.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+
+
+CsvSampleReader::CsvSampleReader(const std::string& fileName, size_t chunkSize) : _file(fileName, std::ios::binary),
+    _buffer(std::max<size_t>(chunkSize, 64)),
+    _begin(0),
+    _end(0),
+    _eof(false),
+    _invalidLines(0)
+{
+    if (!_file.is_open())
+        std::cerr << "Error: Could not open file " << fileName << std::endl;
+}
+
+/* moves the unparsed rest to the front of the buffer and reads the next chunk behind it */
+bool CsvSampleReader::fill()
+{
+    if (_eof)
+        return false;
+
+    std::memmove(_buffer.data(), _buffer.data() + _begin, _end - _begin);
+    _end -= _begin;
+    _begin = 0;
+
+    _file.read(_buffer.data() + _end, _buffer.size() - _end);
+    size_t read = _file.gcount();
+    _end += read;
+    if (read == 0)
+        _eof = true;
+    return read > 0;
+}
+
+bool CsvSampleReader::parseLine(const char* begin, const char* end, float& angle, TimeSeries::Timestamp& time) const
+{
+    auto skipBlanks = [end](const char* c) {
+        while (c < end && (*c == ' ' || *c == '\t'))
+            c++;
+        return c;
+    };
+
+    long long milliseconds;
+    auto [timeEnd, timeError] = std::from_chars(skipBlanks(begin), end, milliseconds);
+    if (timeError != std::errc())
+        return false;
+
+    const char* separator = skipBlanks(timeEnd);
+    if (separator == end || *separator != ',')
+        return false;
+
+    auto [angleEnd, angleError] = std::from_chars(skipBlanks(separator + 1), end, angle);
+    if (angleError != std::errc())
+        return false;
+
+    time = TimeSeries::Timestamp(std::chrono::milliseconds(milliseconds));
+    return true;
+}
+
+bool CsvSampleReader::next(float& angle, TimeSeries::Timestamp& time)
+{
+    if (!isOpen())
+        return false;
+
+    while (true)
+    {
+        const char* data = _buffer.data();
+        auto newline = static_cast<const char*>(std::memchr(data + _begin, '\n', _end - _begin));
+
+        if (!newline)
+        {
+            if (_begin == 0 && _end == _buffer.size())
+            {
+                // line longer than the buffer
+                _invalidLines++;
+                _begin = _end;
+                while (fill())
+                {
+                    auto rest = static_cast<const char*>(std::memchr(data, '\n', _end));
+                    _begin = rest ? rest - data + 1 : _end;
+                    if (rest)
+                        break;
+                }
+                continue;
+            }
+            if (fill())
+                continue;
+            if (_begin == _end)
+                return false;
+            newline = data + _end; // last line without line break
+        }
+
+        const char* line = data + _begin;
+        const char* lineEnd = newline;
+        _begin = std::min<size_t>(newline - data + 1, _end);
+        if (lineEnd > line && lineEnd[-1] == '\r')
+            lineEnd--;
+        if (lineEnd == line)
+            continue; // empty line
+
+        if (parseLine(line, lineEnd, angle, time))
+            return true;
+        _invalidLines++;
+    }
+}
+
+std::optional<TimeSeries> CsvSampleReader::load(const std::string& fileName)
+{
+    CsvSampleReader reader(fileName, 1024 * 1024);
+    if (!reader.isOpen())
+        return std::nullopt;
+
+    TimeSeries samples;
+    float angle;
+    TimeSeries::Timestamp time;
+    while (reader.next(angle, time))
+        samples.add(angle, time);
+
+    if (reader.invalidLines() > 0)
+        std::cerr << "Error: Skipped " << reader.invalidLines() << " invalid lines in " << fileName << std::endl;
+    return samples;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "TimeSeries.h"
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+/*
+* Streaming reader for CSV sensor recordings, one "milliseconds,angle" sample per line, further columns are ignored.
+* The file is read in fixed size chunks and parsed in place with std::from_chars: no allocation after construction
+* and no exceptions, lines that do not parse are skipped and counted.
+*/
+class CsvSampleReader
+{
+public:
+	explicit CsvSampleReader(const std::string& fileName, size_t chunkSize = 64 * 1024);
+
+	bool isOpen() const
+	{
+		return _file.is_open();
+	}
+	size_t invalidLines() const
+	{
+		return _invalidLines;
+	}
+
+	// false at the end of the file
+	bool next(float& angle, TimeSeries::Timestamp& time);
+
+	// whole file as TimeSeries, nullopt if it cannot be opened
+	static std::optional<TimeSeries> load(const std::string& fileName);
+
+private:
+	bool parseLine(const char* begin, const char* end, float& angle, TimeSeries::Timestamp& time) const;
+	bool fill();
+
+private:
+	std::ifstream _file;
+	std::vector<char> _buffer;
+	size_t _begin; // first unparsed character
+	size_t _end; // end of the buffered data
+	bool _eof;
+	size_t _invalidLines;
+};
+
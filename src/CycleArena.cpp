@@ -0,0 +1,47 @@
+#include "CycleArena.h"
+#include <bit>
+#include <cstdint>
+
+
+CycleArena::CycleArena(size_t initialSize) : _block(initialSize),
+    _used(0),
+    _overflowUsed(0)
+{
+}
+
+void CycleArena::reset()
+{
+    // grow to what the last cycle needed, before anything is handed out again
+    if (_overflowUsed > 0)
+    {
+        size_t needed = std::bit_ceil(_used + _overflowUsed);
+        _block = std::vector<std::byte>(needed);
+        _overflow.release();
+    }
+    _used = 0;
+    _overflowUsed = 0;
+}
+
+void* CycleArena::do_allocate(size_t bytes, size_t alignment)
+{
+    auto base = reinterpret_cast<std::uintptr_t>(_block.data());
+    size_t offset = ((base + _used + alignment - 1) & ~(std::uintptr_t)(alignment - 1)) - base;
+    if (offset + bytes <= _block.size())
+    {
+        _used = offset + bytes;
+        return _block.data() + offset;
+    }
+
+    _overflowUsed += bytes + alignment;
+    return _overflow.allocate(bytes, alignment);
+}
+
+void CycleArena::do_deallocate(void*, size_t, size_t)
+{
+    // released by reset()
+}
+
+bool CycleArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+/*
+* Monotonic memory resource for the temporaries of one prediction cycle, all of them are released at once by reset().
+* Allocating is a pointer bump in a preallocated block, deallocating does nothing.
+* If a cycle needs more than the block, the excess comes from the heap and the block is enlarged at the next reset,
+* so after the first few cycles the predictor does not touch the heap for its temporaries.
+*/
+class CycleArena : public std::pmr::memory_resource
+{
+public:
+	CycleArena(size_t initialSize);
+
+	// nothing allocated since the last reset may be used afterwards
+	void reset();
+
+	size_t used() const
+	{
+		return _used + _overflowUsed;
+	}
+	size_t capacity() const
+	{
+		return _block.size();
+	}
+
+private:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+	std::vector<std::byte> _block;
+	size_t _used;
+	std::pmr::monotonic_buffer_resource _overflow;
+	size_t _overflowUsed;
+};
+
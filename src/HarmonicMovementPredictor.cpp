@@ -0,0 +1,165 @@
+#include "HarmonicMovementPredictor.h"
+#include "AsyncLog.h"
+#include "Clock.h"
+#include "Instrumentation.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace
+{
+    // initial uncertainty of the coefficients
+    const double initialCovariance = 1e3;
+}
+
+
+HarmonicMovementPredictor::HarmonicMovementPredictor(Sensor& sensor, std::chrono::milliseconds ms_to_predict,
+    std::chrono::milliseconds ms_to_crossfade, std::chrono::milliseconds transmissionDelay, size_t harmonics, double cyclesInMemory) :
+    AbstractMovementPredictor(sensor, ms_to_predict, ms_to_crossfade, transmissionDelay),
+    _harmonics(std::max<size_t>(harmonics, 1)),
+    _cyclesInMemory(cyclesInMemory),
+    _coefficients(2 * _harmonics + 1),
+    _covariance((2 * _harmonics + 1) * (2 * _harmonics + 1)),
+    _regressors(2 * _harmonics + 1),
+    _gain(2 * _harmonics + 1),
+    _fitting(false)
+{
+}
+
+void HarmonicMovementPredictor::predictMovement(Sensor::Queue& inbound, ConsumeFunction consume, std::function<void(const std::string, TimeSeries&)> monitor)
+{
+    _predictThread = std::thread([this, &inbound, consume, monitor, participant = Clock::Participant()]() {
+        participant.enter();
+        fitThread(inbound, consume, monitor);
+        });
+}
+
+void HarmonicMovementPredictor::fitThread(Sensor::Queue& inbound, ConsumeFunction consume, std::function<void(const std::string, TimeSeries&)> monitor)
+{
+    Tracer::setThreadName("predictor");
+    TimeSeries received;
+    PhaseModel curPrediction;
+
+    inbound.setWakeup(_wakeupSamples, wakeupEvent());
+
+    while (!_shutdownRequested)
+    {
+        inbound.waitForSamples(_maxWakeupInterval);
+        Instrumentation::predictor.recordQueueDepth(inbound.read_available());
+        Instrumentation::LoopTimer loopTimer(Instrumentation::predictor);
+        Tracer::Scope trace("cycle");
+
+        received.clear();
+        inbound.consume_all([&received](const TimeSeries::Sample& sample)
+            {
+                received.add(sample);
+            });
+        monitor("raw", received);
+
+        // the phase of a sample is its position after the last zero crossing, in units of the current period
+        Tracer::Scope fitTrace("fit");
+        for (size_t i = 0; i < received.size(); i++)
+        {
+            auto periodicity = calcPeriodicity(received.view().subView(i, 1));
+            if (!periodicity || std::get<0>(*periodicity) < minPeriodicity || std::get<0>(*periodicity) > maxPeriodicity)
+                continue;
+
+            double period = (double)std::get<0>(*periodicity).count();
+            double memory = _cyclesInMemory * period;
+            double elapsed = (double)(received.time(i) - _lastSampleTime).count();
+            if (!_fitting || elapsed > memory)
+            {
+                // nothing would be left of the old fit after a gap that long
+                resetFit();
+                _fitBegin = received.time(i);
+                _lastSampleTime = received.time(i);
+                _fitting = true;
+                elapsed = 0.0;
+            }
+
+            // the memory is given in ms, so the forgetting depends on the time between the samples, not on the sample rate
+            double phase = 2.0 * std::numbers::pi * (double)(received.time(i) - std::get<1>(*periodicity)).count() / period;
+            addSample(received.angle(i), phase, std::pow(1.0 - 1.0 / memory, std::max(elapsed, 0.0)));
+            _lastSampleTime = std::max(_lastSampleTime, received.time(i));
+        }
+
+        auto periodicity = _periodicityTracker.periodicity();
+        if (!_fitting || !periodicity || received.empty() || received.time(received.size() - 1) - _fitBegin < std::get<0>(*periodicity))
+        {
+            AsyncLog::info("not enough data to predict");
+            continue;
+        }
+
+        std::vector<float> coefficients(_coefficients.begin(), _coefficients.end());
+        auto newPrediction = PhaseModel::fromHarmonics(std::move(coefficients), std::get<1>(*periodicity), PhaseModel::Period((double)std::get<0>(*periodicity).count()));
+        if (!curPrediction.empty())
+        {
+            // every refit changes the coefficients, fade from the renderer's read position so the angle does not jump
+            newPrediction.crossFadeFrom(curPrediction, Clock::now() + _transmissionDelay, _ms_to_crossfade);
+        }
+        curPrediction = std::move(newPrediction);
+        consume(curPrediction, std::get<0>(*periodicity), std::get<1>(*periodicity), std::chrono::milliseconds(0), ""); // no overlay in non-calibration mode
+    }
+}
+
+void HarmonicMovementPredictor::resetFit()
+{
+    size_t n = _coefficients.size();
+    std::fill(_coefficients.begin(), _coefficients.end(), 0.0);
+    std::fill(_covariance.begin(), _covariance.end(), 0.0);
+    for (size_t i = 0; i < n; i++)
+        _covariance[i * n + i] = initialCovariance;
+}
+
+/*
+* One step of recursive least squares with forgetting factor:
+* gain = P x / (forgetting + x' P x), coefficients += gain * error, P = (P - gain x' P) / forgetting
+*/
+void HarmonicMovementPredictor::addSample(float angle, double phase, double forgetting)
+{
+    size_t n = _coefficients.size();
+    auto& x = _regressors;
+
+    x[0] = 1.0;
+    for (size_t k = 1; k <= _harmonics; k++)
+    {
+        x[2 * k - 1] = std::cos((double)k * phase);
+        x[2 * k] = std::sin((double)k * phase);
+    }
+
+    double expected = 0.0;
+    for (size_t i = 0; i < n; i++)
+        expected += _coefficients[i] * x[i];
+
+    // P is symmetric, so P x is also x' P
+    double denominator = forgetting;
+    for (size_t i = 0; i < n; i++)
+    {
+        double sum = 0.0;
+        for (size_t j = 0; j < n; j++)
+            sum += _covariance[i * n + j] * x[j];
+        _gain[i] = sum;
+        denominator += x[i] * sum;
+    }
+
+    double error = angle - expected;
+    for (size_t i = 0; i < n; i++)
+        _coefficients[i] += _gain[i] / denominator * error;
+
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            _covariance[i * n + j] = (_covariance[i * n + j] - _gain[i] * _gain[j] / denominator) / forgetting;
+}
+
+/* fed sample by sample, so the phase of every sample is relative to the period known at its time */
+std::optional<std::tuple<std::chrono::milliseconds, TimeSeries::Timestamp>> HarmonicMovementPredictor::calcPeriodicity(const TimeSeriesView& ts)
+{
+    _periodicityTracker.update(ts);
+    return _periodicityTracker.periodicity();
+}
+
+SampleQueue::WakeupEvent HarmonicMovementPredictor::wakeupEvent() const
+{
+    return SampleQueue::WakeupEvent::FallingZeroCrossing;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "AbstractMovementPredictor.h"
+#include "SinePeriodicityTracker.h"
+#include <vector>
+
+/*
+* Fits the oil pump motion to a Fourier series with a few harmonics of the current period,
+* by recursive least squares with exponential forgetting over the last few cycles.
+* The fit is updated per sample in O(harmonics^2), the prediction is the series itself: a handful of coefficients
+* that can be evaluated for any horizon, with the sensor noise averaged out instead of copied forward.
+*/
+class HarmonicMovementPredictor : public AbstractMovementPredictor
+{
+public:
+	HarmonicMovementPredictor(Sensor& sensor, std::chrono::milliseconds ms_to_predict, std::chrono::milliseconds ms_to_crossfade, std::chrono::milliseconds transmissionDelay,
+		size_t harmonics = 4, double cyclesInMemory = 3.0);
+
+	virtual void predictMovement(Sensor::Queue& inbound, ConsumeFunction consume, std::function<void(const std::string, TimeSeries&)> monitor);
+
+protected:
+	virtual std::optional<std::tuple<std::chrono::milliseconds, TimeSeries::Timestamp>> calcPeriodicity(const TimeSeriesView& ts);
+	virtual SampleQueue::WakeupEvent wakeupEvent() const;
+
+private:
+	void fitThread(Sensor::Queue& inbound, ConsumeFunction consume, std::function<void(const std::string, TimeSeries&)> monitor);
+	void resetFit();
+	void addSample(float angle, double phase, double forgetting);
+
+private:
+	SinePeriodicityTracker _periodicityTracker;
+	size_t _harmonics;
+	double _cyclesInMemory;
+
+	// a0, a1, b1, a2, b2, ... and the inverse correlation matrix of the recursive least squares fit
+	std::vector<double> _coefficients;
+	std::vector<double> _covariance;
+	// scratch buffers of addSample
+	std::vector<double> _regressors;
+	std::vector<double> _gain;
+	TimeSeries::Timestamp _fitBegin;
+	TimeSeries::Timestamp _lastSampleTime; // the forgetting is applied per ms since this sample
+	bool _fitting;
+};
+
@@ -0,0 +1,102 @@
+#include "Histogram.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <sstream>
+
+
+Histogram::Histogram()
+{
+    reset();
+}
+
+void Histogram::reset()
+{
+    for (auto& bucket : _buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    _count.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+/* values below 2 * subBuckets have a bucket each, above that each power of two is split into subBuckets buckets */
+size_t Histogram::bucketIndex(uint64_t value)
+{
+    value = std::min<uint64_t>(value, (uint64_t(1) << maxValueBits) - 1);
+    if (value < 2 * subBuckets)
+        return (size_t)value;
+
+    unsigned shift = std::bit_width(value) - (subBucketBits + 1);
+    return (size_t)(shift * subBuckets + (value >> shift));
+}
+
+/* highest value that falls into the bucket */
+uint64_t Histogram::bucketValue(size_t index)
+{
+    if (index < 2 * subBuckets)
+        return index;
+
+    unsigned shift = (unsigned)(index / subBuckets) - 1;
+    uint64_t subBucket = index % subBuckets + subBuckets;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+void Histogram::record(uint64_t value)
+{
+    _buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t max = _max.load(std::memory_order_relaxed);
+    while (value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+        ;
+}
+
+uint64_t Histogram::count() const
+{
+    return _count.load(std::memory_order_relaxed);
+}
+
+uint64_t Histogram::max() const
+{
+    return _max.load(std::memory_order_relaxed);
+}
+
+double Histogram::mean() const
+{
+    uint64_t count = this->count();
+    return count > 0 ? (double)_sum.load(std::memory_order_relaxed) / (double)count : 0.0;
+}
+
+uint64_t Histogram::percentile(double fraction) const
+{
+    // the buckets are read one by one while recording goes on, so the total is counted from the same snapshot
+    uint64_t counts[bucketCount];
+    uint64_t total = 0;
+    for (size_t i = 0; i < bucketCount; i++)
+    {
+        counts[i] = _buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0)
+        return 0;
+
+    uint64_t rank = std::max<uint64_t>((uint64_t)std::ceil(std::clamp(fraction, 0.0, 1.0) * (double)total), 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucketCount; i++)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+            return std::min(bucketValue(i), max());
+    }
+    return max();
+}
+
+std::string Histogram::summary() const
+{
+    std::ostringstream out;
+    out << "n=" << count() << " mean=" << (uint64_t)std::llround(mean())
+        << " p50=" << percentile(0.5) << " p90=" << percentile(0.9) << " p99=" << percentile(0.99)
+        << " p99.9=" << percentile(0.999) << " max=" << max();
+    return out.str();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/*
+* HDR style histogram of non-negative integer values (latencies in microseconds, counts, queue depths).
+* Buckets are log-linear: exact below 64, above that 32 buckets per power of two, i.e. about 3% resolution up to 2^40.
+* Recording is a few relaxed atomic increments, so a loop can record while another thread reads the statistics.
+*/
+class Histogram
+{
+public:
+	Histogram();
+
+	void record(uint64_t value);
+	void reset();
+
+	uint64_t count() const;
+	uint64_t max() const;
+	double mean() const;
+	// smallest value such that at least the given fraction of the recorded values is not above it, to bucket resolution
+	uint64_t percentile(double fraction) const;
+
+	// count, mean, p50, p90, p99, p99.9 and max in one line
+	std::string summary() const;
+
+private:
+	static constexpr unsigned subBucketBits = 5;
+	static constexpr uint64_t subBuckets = 1 << subBucketBits;
+	static constexpr unsigned maxValueBits = 40;
+	static constexpr size_t bucketCount = (maxValueBits - subBucketBits + 1) * subBuckets;
+
+	static size_t bucketIndex(uint64_t value);
+	static uint64_t bucketValue(size_t index);
+
+private:
+	std::array<std::atomic<uint64_t>, bucketCount> _buckets;
+	std::atomic<uint64_t> _count;
+	std::atomic<uint64_t> _sum;
+	std::atomic<uint64_t> _max;
+};
+
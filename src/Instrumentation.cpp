@@ -0,0 +1,176 @@
+#include "Instrumentation.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+namespace
+{
+    // constant initialized, so it is safe to use from operator new at any time
+    thread_local uint64_t t_allocations = 0;
+
+    void* countedAllocate(std::size_t size)
+    {
+        ++t_allocations;
+        if (void* p = std::malloc(size > 0 ? size : 1))
+            return p;
+        throw std::bad_alloc();
+    }
+}
+
+/* replaced global allocation functions, the nothrow variants of the standard library end up here as well. Over-aligned allocations are not counted */
+void* operator new(std::size_t size)
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return countedAllocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+
+Instrumentation::LoopStats Instrumentation::sensor("sensor");
+Instrumentation::LoopStats Instrumentation::predictor("predictor");
+Instrumentation::LoopStats Instrumentation::render("render");
+
+std::atomic<bool> Instrumentation::_enabled(false);
+std::thread Instrumentation::_reportThread;
+std::mutex Instrumentation::_mutex;
+std::condition_variable Instrumentation::_cv;
+bool Instrumentation::_stopRequested = false;
+
+
+void Instrumentation::LoopStats::record(std::chrono::nanoseconds latency, uint64_t allocations)
+{
+    _latencyMicros.record((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+    _allocations.record(allocations);
+}
+
+void Instrumentation::LoopStats::recordQueueDepth(size_t depth)
+{
+    if (enabled())
+        _queueDepth.record(depth);
+}
+
+void Instrumentation::LoopStats::recordSchedulingError(std::chrono::nanoseconds lateness)
+{
+    if (enabled())
+        _schedulingErrorNanos.record((uint64_t)std::max<int64_t>(lateness.count(), 0));
+}
+
+std::string Instrumentation::LoopStats::summary() const
+{
+    std::ostringstream out;
+    if (_latencyMicros.count() == 0)
+    {
+        out << _name << ": no iterations\n";
+        return out.str();
+    }
+    out << _name << " latency us: " << _latencyMicros.summary() << "\n"
+        << _name << " allocations: " << _allocations.summary() << "\n";
+    if (_queueDepth.count() > 0)
+        out << _name << " queue depth: " << _queueDepth.summary() << "\n";
+    if (_schedulingErrorNanos.count() > 0)
+        out << _name << " scheduling error ns: " << _schedulingErrorNanos.summary() << "\n";
+    return out.str();
+}
+
+Instrumentation::LoopTimer::LoopTimer(LoopStats& stats) : _stats(enabled() ? &stats : nullptr),
+    _allocations(0)
+{
+    if (_stats)
+    {
+        _allocations = t_allocations;
+        _begin = std::chrono::steady_clock::now();
+    }
+}
+
+Instrumentation::LoopTimer::~LoopTimer()
+{
+    stop();
+}
+
+void Instrumentation::LoopTimer::stop()
+{
+    if (_stats)
+        _stats->record(std::chrono::steady_clock::now() - _begin, t_allocations - _allocations);
+    _stats = nullptr;
+}
+
+uint64_t Instrumentation::threadAllocations()
+{
+    return t_allocations;
+}
+
+void Instrumentation::start(std::chrono::seconds interval)
+{
+    _enabled.store(true, std::memory_order_relaxed);
+    {
+        std::scoped_lock lock(_mutex);
+        _stopRequested = false;
+    }
+    _reportThread = std::thread([interval]() {
+        reportThread(interval);
+        });
+}
+
+void Instrumentation::stop()
+{
+    if (!_reportThread.joinable())
+        return;
+
+    {
+        std::scoped_lock lock(_mutex);
+        _stopRequested = true;
+    }
+    _cv.notify_all();
+    _reportThread.join();
+    _enabled.store(false, std::memory_order_relaxed);
+    dump();
+}
+
+void Instrumentation::dump()
+{
+    std::cout << sensor.summary() << predictor.summary() << render.summary() << std::flush;
+}
+
+void Instrumentation::reportThread(std::chrono::seconds interval)
+{
+    std::unique_lock lock(_mutex);
+    while (!_stopRequested)
+    {
+        if (interval.count() <= 0)
+        {
+            _cv.wait(lock, [] { return _stopRequested; });
+            break;
+        }
+        if (_cv.wait_for(lock, interval, [] { return _stopRequested; }))
+            break;
+
+        lock.unlock();
+        dump();
+        lock.lock();
+    }
+}
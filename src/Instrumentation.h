@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "Histogram.h"
+
+/*
+* Built-in statistics of the hot loops: latency per iteration, heap allocations per iteration, depth of the inbound queue
+* and how late a scheduled loop (the replay) woke up.
+* Allocations are counted per thread by the replaced global operator new.
+* Recording is off until start() is called, a disabled LoopTimer costs one relaxed load.
+*/
+class Instrumentation
+{
+public:
+	class LoopStats
+	{
+	public:
+		LoopStats(const char* name) : _name(name)
+		{
+		}
+
+		void record(std::chrono::nanoseconds latency, uint64_t allocations);
+		void recordQueueDepth(size_t depth);
+		void recordSchedulingError(std::chrono::nanoseconds lateness);
+		std::string summary() const;
+
+	private:
+		const char* _name;
+		Histogram _latencyMicros;
+		Histogram _allocations;
+		Histogram _queueDepth;
+		Histogram _schedulingErrorNanos;
+	};
+
+	// measures one iteration of a loop, from construction to stop() or destruction
+	class LoopTimer
+	{
+	public:
+		LoopTimer(LoopStats& stats);
+		~LoopTimer();
+		// ends the measurement early, e.g. before a loop sleeps
+		void stop();
+
+	private:
+		LoopStats* _stats;
+		std::chrono::steady_clock::time_point _begin;
+		uint64_t _allocations;
+	};
+
+	static LoopStats sensor;
+	static LoopStats predictor;
+	static LoopStats render;
+
+	static bool enabled()
+	{
+		return _enabled.load(std::memory_order_relaxed);
+	}
+	// heap allocations of the calling thread so far
+	static uint64_t threadAllocations();
+
+	// enables recording, the statistics are written to stdout every interval (never if 0) and by stop()
+	static void start(std::chrono::seconds interval);
+	static void stop();
+	static void dump();
+
+private:
+	static void reportThread(std::chrono::seconds interval);
+
+private:
+	static std::atomic<bool> _enabled;
+	static std::thread _reportThread;
+	static std::mutex _mutex;
+	static std::condition_variable _cv;
+	static bool _stopRequested;
+};
+
@@ -1,4 +1,6 @@
 #include "Monitor.h"
+#include "Clock.h"
+#include "Tracer.h"
 #include <fstream>
 #include <sstream>
 
@@ -20,6 +22,7 @@ void Monitor::monitor()
 
 void Monitor::monitorThread()
 {
+    Tracer::setThreadName("monitor");
     int i = 0;
     std::unique_lock<std::mutex> lock(_mutex, std::defer_lock);
     while (true) {
@@ -41,6 +44,7 @@ void Monitor::monitorThread()
             }
 
             // Plot the current data to a file
+            Tracer::Scope trace("plot");
             std::stringstream filename;
             filename << "plot_" << i << ".gnuplot";
             plot(filename.str(), local_data);
@@ -50,10 +54,9 @@ void Monitor::monitorThread()
                 std::scoped_lock scopedLock(_mutex);
                 for (auto& entry : _data) {
                     auto& series = entry.second;
-                    auto endTime = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now());
+                    auto endTime = Clock::now();
                     auto startTime = endTime - std::chrono::seconds(5);
-                    auto slicedSeries = series.slice(startTime, endTime);
-                    series = slicedSeries;
+                    series = TimeSeries(series.slice(startTime, endTime));
                 }
             }
         }
@@ -89,18 +92,18 @@ void Monitor::plot(const std::string& filename, std::map<std::string, TimeSeries
     // Find the maximum number of samples across all time series
     size_t maxSamples = 0;
     for (auto& entry : data) {
-        maxSamples = std::max(maxSamples, entry.second.getVector().size());
+        maxSamples = std::max(maxSamples, entry.second.size());
     }
 
     // Write the data for each time series to the CSV file
     for (size_t i = 0; i < maxSamples; ++i) {
         for ( auto& entry : data) {
             auto& series = entry.second;
-            if (i < series.getVector().size()) {
+            if (i < series.size()) {
                 // Write the timestamp for this time series
-                outFile << std::get<1>(series.getVector()[i]).time_since_epoch().count() << ",";
+                outFile << series.time(i).time_since_epoch().count() << ",";
                 // Write the value for this time series
-                outFile << std::get<0>(series.getVector()[i]) << ",";
+                outFile << series.angle(i) << ",";
             }
             else {
                 // Write empty values if there are no more data points for this time series
@@ -3,19 +3,41 @@
 #include <boost/circular_buffer.hpp>
 #include <boost/lexical_cast.hpp>
 #include "Monitor.h"
+#include "Tracer.h"
 
 
 
 OilPumpMovementPredictor::OilPumpMovementPredictor(Sensor& sensor, std::chrono::milliseconds ms_to_predict, 
-                                     std::chrono::milliseconds ms_to_crossfade, std::chrono::milliseconds transmissionDelay) : 
-                            AbstractMovementPredictor(sensor, ms_to_predict, ms_to_crossfade,  transmissionDelay)
+                                     std::chrono::milliseconds ms_to_crossfade, std::chrono::milliseconds transmissionDelay, PeriodicityMethod periodicityMethod) :
+                            AbstractMovementPredictor(sensor, ms_to_predict, ms_to_crossfade,  transmissionDelay),
+                            _periodicityMethod(periodicityMethod),
+                            _periodEstimator(minPeriodicity, maxPeriodicity)
 {
 }
 
 
 
-std::optional<std::tuple<std::chrono::milliseconds, TimeSeries::Timestamp>> OilPumpMovementPredictor::calcPeriodicity(TimeSeries& ts)
+std::optional<std::tuple<std::chrono::milliseconds, TimeSeries::Timestamp>> OilPumpMovementPredictor::calcPeriodicity(const TimeSeriesView& ts)
 {
+    Tracer::Scope trace("periodicity");
+    // only the samples added since the last call are processed
+    _periodicityTracker.update(ts);
+    if (_periodicityMethod == PeriodicityMethod::ZeroCrossing)
+        return _periodicityTracker.periodicity();
 
-    return ts.calcPeriodicitySine();
+    // a single zero crossing is enough as phase reference, the period itself comes from the whole signal
+    if (_periodicityTracker.transitions().empty())
+        return std::nullopt;
+
+    auto period = _periodEstimator.estimate(ts);
+    if (!period)
+        return std::nullopt;
+
+    std::tuple<std::chrono::milliseconds, TimeSeries::Timestamp> ret = { std::chrono::round<std::chrono::milliseconds>(*period), _periodicityTracker.transitions().back() };
+    return ret;
+}
+
+SampleQueue::WakeupEvent OilPumpMovementPredictor::wakeupEvent() const
+{
+    return SampleQueue::WakeupEvent::FallingZeroCrossing;
 }
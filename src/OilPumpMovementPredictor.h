@@ -3,15 +3,31 @@
 #include "Sensor.h"
 #include <thread>
 #include "AbstractMovementPredictor.h"
+#include "SinePeriodicityTracker.h"
+#include "AutocorrelationPeriodEstimator.h"
 #include <tuple>
 
 class OilPumpMovementPredictor : public AbstractMovementPredictor
 {
 public:
-	OilPumpMovementPredictor(Sensor& sensor, std::chrono::milliseconds ms_to_predict, std::chrono::milliseconds ms_to_crossfade, std::chrono::milliseconds transmissionDelay);
+	// how the period of the pump is detected, the begin of a period is always the last falling zero crossing
+	enum class PeriodicityMethod
+	{
+		ZeroCrossing,
+		Autocorrelation
+	};
+
+	OilPumpMovementPredictor(Sensor& sensor, std::chrono::milliseconds ms_to_predict, std::chrono::milliseconds ms_to_crossfade, std::chrono::milliseconds transmissionDelay,
+		PeriodicityMethod periodicityMethod = PeriodicityMethod::ZeroCrossing);
 
 protected:
-	virtual std::optional<std::tuple<std::chrono::milliseconds, TimeSeries::Timestamp>> calcPeriodicity(TimeSeries& ts);
+	virtual std::optional<std::tuple<std::chrono::milliseconds, TimeSeries::Timestamp>> calcPeriodicity(const TimeSeriesView& ts);
+	virtual SampleQueue::WakeupEvent wakeupEvent() const;
+
+private:
+	PeriodicityMethod _periodicityMethod;
+	SinePeriodicityTracker _periodicityTracker;
+	AutocorrelationPeriodEstimator _periodEstimator;
 
 
 
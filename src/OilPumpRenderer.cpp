@@ -1,11 +1,11 @@
 #include "OilPumpRenderer.h"
-#include <boost/log/trivial.hpp>
+#include "AsyncLog.h"
 
 int positive_mod(int a, int b) {
 
     if (b == 0)
     {
-        BOOST_LOG_TRIVIAL(info) << "mod by zero\n";
+        AsyncLog::info("mod by zero");
         return 0;
     }
 
@@ -27,33 +27,25 @@ OilPumpRenderer::OilPumpRenderer(const std::string& fileName, int zeroAnglePos,
 }
 
 
-float OilPumpRenderer::findAngleToRender(std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> ts, TimeSeries& localTS)
+float OilPumpRenderer::findAngleToRender(std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> ts, const PredictionSnapshot& snapshot)
 {
-    int frame_to_render = 0;
-    float angle = 0.0;
-    auto ind = localTS.findIndex(ts + _transmissionDelay);
-    if (ind)
-    {
-        angle = std::get<0>(localTS.getVector()[*ind]);
-
-    }
-    return angle;
+    return snapshot.model.angleAt(ts + _transmissionDelay);
 }
 
 int OilPumpRenderer::findFrameToRender(std::optional<int> prevFrame, float angle,
-    std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> refNow, TimeSeries& localTS)
+    std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> refNow, const PredictionSnapshot& snapshot)
 {
-    if (_periodicity.count() == 0)
+    if (snapshot.periodicity.count() == 0)
         return 0;
 
     refNow += _transmissionDelay;
-    //BOOST_LOG_TRIVIAL(info) << "cur rotation offset: " << _curRoationOffset << std::endl;
-    auto posInCurRotation = std::chrono::milliseconds((refNow - _lastPeriodBegin + _curRoationOffset).count() % (_periodicity.count() - _curRoationOffset.count()));
+    //BOOST_LOG_TRIVIAL(info) << "cur rotation offset: " << snapshot.curRoationOffset << std::endl;
+    auto posInCurRotation = std::chrono::milliseconds((refNow - snapshot.lastPeriodBegin + snapshot.curRoationOffset).count() % (snapshot.periodicity.count() - snapshot.curRoationOffset.count()));
     //BOOST_LOG_TRIVIAL(info) << "posInCurRotation: " << posInCurRotation.count() << std::endl;
 
     
-    auto time_per_frame = (float)_periodicity.count() / (float)_textures.size();
-    float relative_pos = (float)posInCurRotation.count() / ((float)_periodicity.count() - (float)_curRoationOffset.count());
+    auto time_per_frame = (float)snapshot.periodicity.count() / (float)_textures.size();
+    float relative_pos = (float)posInCurRotation.count() / ((float)snapshot.periodicity.count() - (float)snapshot.curRoationOffset.count());
     int frameToRenderRawNotWrapped = relative_pos * (float)_textures.size() + _zeroAnglePos;
     int frameToRenderRaw = frameToRenderRawNotWrapped;
 
@@ -77,7 +69,7 @@ int OilPumpRenderer::findFrameToRender(std::optional<int> prevFrame, float angle
 
         if (std::abs(frameToRenderRaw - speedCompPrevFrame) * time_per_frame > 500) // skips bigger 500 ms are seeked
         {
-            BOOST_LOG_TRIVIAL(info) << "seeking to due to large time gap: " << std::abs(frameToRenderRaw - speedCompPrevFrame) * time_per_frame << std::endl;
+            AsyncLog::info("seeking to due to large time gap: {}", std::abs(frameToRenderRaw - speedCompPrevFrame) * time_per_frame);
         }
         else
         {
@@ -102,11 +94,11 @@ int OilPumpRenderer::findFrameToRender(std::optional<int> prevFrame, float angle
     //if (frameToRenderFromMatch)
     //    frameToRender = *frameToRenderFromMatch;
 
-    //BOOST_LOG_TRIVIAL(info) << "periodicity: " << _periodicity;
+    //BOOST_LOG_TRIVIAL(info) << "periodicity: " << snapshot.periodicity;
     //BOOST_LOG_TRIVIAL(info) << "pos in period: " << posInCurRotation << " rel pos: " << relative_pos;
     //BOOST_LOG_TRIVIAL(info) << "frame_to_render: " << frameToRender << " frame to render angel: " << std::get<1>(_textures[frameToRender]) << " rot angele: " << angle << " frame_as_per_time: " << frameToRenderRawNotWrapped << std::endl;
     if (prevFrame && frameToRender - *prevFrame > 10)
-        BOOST_LOG_TRIVIAL(info) << "large frame skip from: " << *prevFrame << " to " << frameToRender << std::endl;
+        AsyncLog::info("large frame skip from: {} to {}", *prevFrame, frameToRender);
     prevFrame = frameToRender;
     return frameToRender;
   
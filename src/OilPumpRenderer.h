@@ -6,8 +6,8 @@ class OilPumpRenderer :
 public:
     OilPumpRenderer(const std::string& fileName, int zeroAnglePos, bool fullscreen, float scale, std::chrono::milliseconds transmissionDelay);
     int findFrameToRender(std::optional<int> prevFrame, float angle,
-        std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> refNow, TimeSeries& localTS);
-    float findAngleToRender(std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> ts, TimeSeries& localTS);
+        std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> refNow, const PredictionSnapshot& snapshot);
+    float findAngleToRender(std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> ts, const PredictionSnapshot& snapshot);
 
 public:
     int _zeroAnglePos;
@@ -1,5 +1,8 @@
 #include <GL/glew.h>
 #include "OpenGLRenderer.h"
+#include "Clock.h"
+#include "Instrumentation.h"
+#include "Tracer.h"
 #include <boost/log/trivial.hpp>
 #include <SDL.h>
 #include <SDL_opengl.h>
@@ -261,15 +264,13 @@ void OpenGLRenderer::close() {
 }
 
 
-TimeSeries OpenGLRenderer::_curTimeSeries;
-std::mutex OpenGLRenderer::_mutTimeSeries;
-
-
-
 OpenGLRenderer::OpenGLRenderer(const std::string& fileName, bool fullscreen,  float scale) : _fileName(fileName),
     _fullscreen(fullscreen),
     _scale(scale),
-    _shutdownRequested(false)
+    _shutdownRequested(false),
+    _headless(false),
+    _frameInterval(0),
+    _runTime(0)
 {
     //gFileName = fileName;
     //gzeroAnglePos = zeroAnglePos;
@@ -282,13 +283,16 @@ OpenGLRenderer::~OpenGLRenderer()
 
 
 
-void OpenGLRenderer::feedData(const TimeSeries& ts, std::chrono::milliseconds periodicity, TimeSeries::Timestamp lastPeriodBegin, std::chrono::milliseconds curRoationOffset, const std::string& overlay)
+void OpenGLRenderer::feedData(const PhaseModel& model, std::chrono::milliseconds periodicity, TimeSeries::Timestamp lastPeriodBegin, std::chrono::milliseconds curRoationOffset, const std::string& overlay)
 {
-    std::scoped_lock lock(_mutTimeSeries);
-    _periodicity = periodicity;
-    _curTimeSeries = ts;
-    _curRoationOffset = curRoationOffset;
-    _lastPeriodBegin = lastPeriodBegin;
+    Tracer::Scope trace("feedData");
+    // the model only holds shared pointers to its cycles, so copying it into the slot is cheap
+    PredictionSnapshot& snapshot = _predictions.back();
+    snapshot.model = model;
+    snapshot.periodicity = periodicity;
+    snapshot.lastPeriodBegin = lastPeriodBegin;
+    snapshot.curRoationOffset = curRoationOffset;
+    _predictions.publish();
     //gOverlay = overlay;
 }
 
@@ -311,8 +315,10 @@ void OpenGLRenderer::shutdown()
 
 void OpenGLRenderer::renderQuad(int textureID, int width, int height, float angle)
 {
-    
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    {
+        Tracer::Scope trace("bindTexture");
+        glBindTexture(GL_TEXTURE_2D, textureID);
+    }
 
     // Calculate the position of the quad to be centered
     float quadLeft = (screenWidth - width * _scale) / 2.0f;
@@ -337,6 +343,7 @@ void OpenGLRenderer::renderQuad(int textureID, int width, int height, float angl
 
 void OpenGLRenderer::renderThread(std::function<void(const std::string, TimeSeries&)> monitor)
 {
+    Tracer::setThreadName("render");
     // Start up SDL and create window
     if (!init()) {
         printf("Failed to initialize!\n");
@@ -371,7 +378,8 @@ void OpenGLRenderer::renderThread(std::function<void(const std::string, TimeSeri
             std::optional<int> prevFrame;
             // While application is running
             while (!_shutdownRequested) {
-                auto ts_frame_begin = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now());
+                Instrumentation::LoopTimer frameTimer(Instrumentation::render);
+                Tracer::Scope trace("frame");
                 
                 SDL_Event e;
 
@@ -394,56 +402,105 @@ void OpenGLRenderer::renderThread(std::function<void(const std::string, TimeSeri
                 }
             
 
-                float angle = 0.0f;
+                auto [frame_to_render, angle] = selectFrame(Clock::now(), prevFrame, monitor);
 
 
-                TimeSeries localTS;
 
-                {
-                    std::scoped_lock lock(_mutTimeSeries);
-                    localTS = _curTimeSeries;
-                }
+                glClear(GL_COLOR_BUFFER_BIT);
+                glLoadIdentity();
 
 
-                auto now = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now());
+                renderQuad(std::get<2>(_textures[frame_to_render]), _textureWidth, _textureHeight, angle);
 
+                {
+                    Tracer::Scope trace("swap");
+                    SDL_GL_SwapWindow(gWindow);
+                }
+                SDL_Delay(5);
+            }
+        }
 
-                angle = findAngleToRender(now, localTS);
-                
+    }
+    glDisable(GL_TEXTURE_2D);
+    // Free resources and close SDL
+    close();
+}
 
-                auto frame_to_render = findFrameToRender(prevFrame, angle, now, localTS);
-                
-                
-                prevFrame = frame_to_render;
 
-                TimeSeries renderedAngleTs;
-                renderedAngleTs.add({ angle, std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()), 0 });
-                monitor("rendered", renderedAngleTs);
 
+std::tuple<int, float> OpenGLRenderer::selectFrame(TimeSeries::Timestamp now, std::optional<int>& prevFrame, const std::function<void(const std::string, TimeSeries&)>& monitor)
+{
+    // newest prediction, no lock and no copy
+    const PredictionSnapshot& snapshot = _predictions.read();
 
+    float angle = findAngleToRender(now, snapshot);
+    int frame = findFrameToRender(prevFrame, angle, now, snapshot);
+    prevFrame = frame;
 
-                glClear(GL_COLOR_BUFFER_BIT);
-                glLoadIdentity();
+    TimeSeries renderedAngleTs;
+    renderedAngleTs.add({ angle, now, 0 });
+    monitor("rendered", renderedAngleTs);
+    return { frame, angle };
+}
 
+void OpenGLRenderer::setHeadless(std::chrono::milliseconds frameInterval, std::chrono::milliseconds runTime, const std::string& frameLog)
+{
+    _headless = true;
+    _frameInterval = std::max(frameInterval, std::chrono::milliseconds(1));
+    _runTime = runTime;
+    _frameLog = frameLog;
+    // registered here, before main releases the virtual clock
+    _clockParticipant.emplace();
+}
 
-                renderQuad(std::get<2>(_textures[frame_to_render]), _textureWidth, _textureHeight, angle);
+/* same frame selection as the window, paced by the Clock instead of vsync, no SDL and no GL calls */
+void OpenGLRenderer::headlessThread(std::function<void(const std::string, TimeSeries&)> monitor)
+{
+    Tracer::setThreadName("render");
+    _clockParticipant->enter();
 
-                SDL_GL_SwapWindow(gWindow);
-                SDL_Delay(5);
+    // frame infos only, no textures are loaded
+    for (const auto& file : getFilesSorted(_fileName))
+        _textures.push_back({ std::get<1>(file), std::get<2>(file), 0 });
 
-                auto ts_frame_end = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now());
+    std::ofstream frameLog;
+    if (!_frameLog.empty())
+    {
+        frameLog.open(_frameLog);
+        frameLog << "time,frame,angle\n";
+    }
 
-  //              BOOST_LOG_TRIVIAL(info) << "frame time: " << std::chrono::duration_cast<std::chrono::milliseconds>(ts_frame_end - ts_frame_begin).count() << std::endl;
+    if (_textures.empty())
+    {
+        BOOST_LOG_TRIVIAL(info) << "No frames found in " << _fileName;
+    }
+    else
+    {
+        std::optional<int> prevFrame;
+        auto start = Clock::now();
+        auto next = start;
+        while (!_shutdownRequested && (_runTime.count() <= 0 || Clock::now() - start < _runTime))
+        {
+            auto now = Clock::now();
+            std::tuple<int, float> selected;
+            {
+                Instrumentation::LoopTimer frameTimer(Instrumentation::render);
+                Tracer::Scope trace("frame");
+                selected = selectFrame(now, prevFrame, monitor);
             }
-        }
 
-    }
-    glDisable(GL_TEXTURE_2D);
-    // Free resources and close SDL
-    close();
-}
+            // file output is not part of the measured frame time
+            if (frameLog.is_open())
+                frameLog << now.time_since_epoch().count() << ',' << std::get<0>(selected) << ',' << std::get<1>(selected) << '\n';
 
+            next += _frameInterval;
+            Instrumentation::render.recordSchedulingError(Clock::sleepUntil(next));
+        }
+    }
 
+    // the virtual clock goes on without the renderer
+    _clockParticipant.reset();
+}
 
 void OpenGLRenderer::render(std::function<void(const std::string, TimeSeries&)> monitor)
 {
@@ -451,7 +508,10 @@ void OpenGLRenderer::render(std::function<void(const std::string, TimeSeries&)>
     //_renderThread = std::thread([this, monitor]() {
     //    renderThread(monitor);
     //    });
-    renderThread(monitor);
+    if (_headless)
+        headlessThread(monitor);
+    else
+        renderThread(monitor);
 
 
 }
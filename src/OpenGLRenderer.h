@@ -1,10 +1,15 @@
 #pragma once
 #include "Renderer.h"
+#include "Clock.h"
+#include "TripleBuffer.h"
+#include "PredictionSnapshot.h"
 
 
 #include <atomic>
 #include <functional>
+#include <optional>
 #include <thread>
+#include <tuple>
 
 struct SDL_Texture;
 namespace gli
@@ -19,8 +24,14 @@ public:
 	virtual ~OpenGLRenderer();
 
 public:
-	virtual void feedData(const TimeSeries& ts, std::chrono::milliseconds periodicity, TimeSeries::Timestamp, std::chrono::milliseconds, const std::string& overlay);
+	virtual void feedData(const PhaseModel& model, std::chrono::milliseconds periodicity, TimeSeries::Timestamp, std::chrono::milliseconds, const std::string& overlay);
 	void shutdown();
+	/*
+	* Renders without window and GL context: the frame selection runs every frameInterval (Clock time) and writes
+	* time, frame and angle per tick to frameLog (none if empty), for benchmarks on a build box together with replay.
+	* Stops after runTime, never if 0. Call before the virtual clock is released.
+	*/
+	void setHeadless(std::chrono::milliseconds frameInterval, std::chrono::milliseconds runTime, const std::string& frameLog);
 	void render(std::function<void(const std::string, TimeSeries&)> monitor);
 	void renderThread(std::function<void(const std::string, TimeSeries&)> monitor);
 	typedef std::tuple<std::string, float, int> FrameInfo;
@@ -28,12 +39,15 @@ public:
 
 protected:
 	void renderThread();
+	void headlessThread(std::function<void(const std::string, TimeSeries&)> monitor);
+	// frame and angle to show at now, from the newest prediction
+	std::tuple<int, float> selectFrame(TimeSeries::Timestamp now, std::optional<int>& prevFrame, const std::function<void(const std::string, TimeSeries&)>& monitor);
 	bool init();
 	bool loadMedia(const std::string& directory);
 	void close();
 	std::vector<OpenGLRenderer::FrameInfo> getFilesSorted(const std::string& directory);
-	virtual int findFrameToRender(std::optional<int> prevFrame, float angle, std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> ts, TimeSeries& localTS) = 0;
-	virtual float findAngleToRender(std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> ts, TimeSeries& localTS) = 0;
+	virtual int findFrameToRender(std::optional<int> prevFrame, float angle, std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> ts, const PredictionSnapshot& snapshot) = 0;
+	virtual float findAngleToRender(std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> ts, const PredictionSnapshot& snapshot) = 0;
 	void CreateTexture(const OpenGLRenderer::FrameInfo& info);
 	void renderQuad(int textureID, int width, int height, float angle);
 	TimeSeries createTextureTimeSeries(const std::vector<OpenGLRenderer::TextureInfo>& textures, 
@@ -44,8 +58,8 @@ public:
 	std::atomic<bool> _shutdownRequested;
 	//static std::atomic<bool> _quit;
 	std::thread _renderThread;
-	static TimeSeries _curTimeSeries;
-	static std::mutex _mutTimeSeries;
+	// written by the predictor thread in feedData, read by the render thread without locking
+	TripleBuffer<PredictionSnapshot> _predictions;
 	bool _fullscreen;
 	float _scale;
 	
@@ -60,10 +74,13 @@ public:
 	
 	
 	std::vector<TextureInfo> _textures;
-	TimeSeries::Timestamp _lastPeriodBegin;
-	std::chrono::milliseconds _curRoationOffset;
-	std::chrono::milliseconds _periodicity;
 	int _textureWidth;
 	int _textureHeight;
 
+	bool _headless;
+	std::chrono::milliseconds _frameInterval;
+	std::chrono::milliseconds _runTime;
+	std::string _frameLog;
+	std::optional<Clock::Participant> _clockParticipant;
+
 };
\ No newline at end of file
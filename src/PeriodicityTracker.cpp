@@ -0,0 +1,50 @@
+#include "PeriodicityTracker.h"
+#include <algorithm>
+
+
+PeriodicityTracker::PeriodicityTracker(size_t historySize) : _transitions(std::max<size_t>(historySize, 2))
+{
+}
+
+PeriodicityTracker::~PeriodicityTracker()
+{
+}
+
+void PeriodicityTracker::update(const TimeSeriesView& ts)
+{
+    size_t begin = 0;
+    if (_prevAngle)
+        begin = ts.upperBound(_prevTime);
+
+    auto angles = ts.angles();
+    for (size_t i = begin; i < ts.size(); i++)
+        add(angles[i], ts.time(i));
+}
+
+void PeriodicityTracker::add(float angle, Timestamp time)
+{
+    // the transition is attributed to the last sample before it, like TimeSeries::calcPeriodicitySine does
+    if (_prevAngle && isTransition(*_prevAngle, angle))
+        _transitions.push_back(_prevTime);
+
+    _prevAngle = angle;
+    _prevTime = time;
+}
+
+void PeriodicityTracker::reset()
+{
+    _transitions.clear();
+    _prevAngle.reset();
+    resetHysteresis();
+}
+
+std::optional<std::tuple<std::chrono::milliseconds, PeriodicityTracker::Timestamp>> PeriodicityTracker::periodicity() const
+{
+    if (_transitions.size() < 2)
+        return std::nullopt;
+
+    auto last = _transitions[_transitions.size() - 1];
+    auto secondLast = _transitions[_transitions.size() - 2];
+    std::tuple<std::chrono::milliseconds, Timestamp> ret = { std::chrono::duration_cast<std::chrono::milliseconds>(last - secondLast), last };
+    return ret;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <boost/circular_buffer.hpp>
+#include <chrono>
+#include <optional>
+#include <tuple>
+#include "TimeSeriesView.h"
+
+/*
+* Stateful period detection: samples are fed as they arrive and every transition (e.g. a zero crossing) is recorded once.
+* Querying the current period and the begin of the last period is O(1), independent of the length of the buffered signal.
+* Subclasses define what a transition is and apply a hysteresis, so noise around the threshold does not produce double transitions.
+*/
+class PeriodicityTracker
+{
+public:
+	typedef TimeSeriesView::Timestamp Timestamp;
+
+	PeriodicityTracker(size_t historySize = 8);
+	virtual ~PeriodicityTracker();
+
+	// feeds all samples of ts newer than the latest sample fed so far
+	void update(const TimeSeriesView& ts);
+	void add(float angle, Timestamp time);
+	void reset();
+
+	// period between the last two transitions and the timestamp of the last transition
+	std::optional<std::tuple<std::chrono::milliseconds, Timestamp>> periodicity() const;
+	const boost::circular_buffer<Timestamp>& transitions() const
+	{
+		return _transitions;
+	}
+
+protected:
+	// called for every pair of consecutive samples, returns true if the step from prevAngle to angle completes a period
+	virtual bool isTransition(float prevAngle, float angle) = 0;
+	virtual void resetHysteresis() = 0;
+
+private:
+	boost::circular_buffer<Timestamp> _transitions;
+	std::optional<float> _prevAngle;
+	Timestamp _prevTime;
+};
+
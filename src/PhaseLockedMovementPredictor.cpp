@@ -0,0 +1,213 @@
+#include "PhaseLockedMovementPredictor.h"
+#include "AsyncLog.h"
+#include "Clock.h"
+#include "Instrumentation.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // measurement noise of the sensor in deg^2
+    const double measurementVariance = 0.25;
+    // random walk of the phase (cycles^2 per ms) and of the frequency ((cycles per ms)^2 per ms)
+    const double phaseNoise = 1e-10;
+    const double frequencyNoise = 1e-16;
+    // adaption rate of the cycle template
+    const float templateAdaption = 0.01f;
+    // lock is considered lost if the normalized innovations average above this
+    const double maxInnovationLevel = 9.0;
+}
+
+
+PhaseLockedMovementPredictor::PhaseLockedMovementPredictor(Sensor& sensor, std::chrono::milliseconds ms_to_predict,
+    std::chrono::milliseconds ms_to_crossfade, std::chrono::milliseconds transmissionDelay, size_t templateSize) :
+    AbstractMovementPredictor(sensor, ms_to_predict, ms_to_crossfade, transmissionDelay),
+    _template(std::max<size_t>(templateSize, 8)),
+    _locked(false),
+    _phase(0.0),
+    _frequency(0.0),
+    _p00(0.0), _p01(0.0), _p11(0.0),
+    _innovationLevel(0.0)
+{
+}
+
+void PhaseLockedMovementPredictor::predictMovement(Sensor::Queue& inbound, ConsumeFunction consume, std::function<void(const std::string, TimeSeries&)> monitor)
+{
+    _predictThread = std::thread([this, &inbound, consume, monitor, participant = Clock::Participant()]() {
+        participant.enter();
+        trackThread(inbound, consume, monitor);
+        });
+}
+
+void PhaseLockedMovementPredictor::trackThread(Sensor::Queue& inbound, ConsumeFunction consume, std::function<void(const std::string, TimeSeries&)> monitor)
+{
+    Tracer::setThreadName("predictor");
+    // raw history, only needed to (re-)acquire the lock
+    RingTimeSeries history((size_t)(inboundWindowPeriods * maxPeriodicity.count()) + 4096);
+    TimeSeries received;
+    PhaseModel curPrediction;
+
+    inbound.setWakeup(_wakeupSamples, wakeupEvent());
+
+    while (!_shutdownRequested)
+    {
+        inbound.waitForSamples(_maxWakeupInterval);
+        Instrumentation::predictor.recordQueueDepth(inbound.read_available());
+        Instrumentation::LoopTimer loopTimer(Instrumentation::predictor);
+        Tracer::Scope trace("cycle");
+
+        received.clear();
+        inbound.consume_all([&history, &received](const TimeSeries::Sample& sample)
+            {
+                history.add(sample);
+                received.add(sample);
+            });
+        monitor("raw", received);
+        if (history.empty())
+            continue;
+
+        auto period = calcPeriodicity(history);
+        auto window = period && std::get<0>(*period) <= maxPeriodicity ? std::get<0>(*period) : maxPeriodicity;
+        history.dropBefore(history.time(history.size() - 1) - std::chrono::milliseconds((int)(inboundWindowPeriods * window.count())));
+
+        if (_locked)
+        {
+            for (size_t i = 0; i < received.size(); i++)
+                updateState(received.angle(i), received.time(i));
+
+            if (_innovationLevel > maxInnovationLevel)
+            {
+                AsyncLog::info("phase lock lost");
+                _locked = false;
+            }
+        }
+
+        if (!_locked && !acquireLock(history))
+        {
+            AsyncLog::info("not enough data to predict");
+            continue;
+        }
+
+        auto periodicity = std::chrono::milliseconds((int64_t)std::llround(1.0 / _frequency));
+        PhaseModel newPrediction(_template, lastPeriodBegin(), PhaseModel::Period(1.0 / _frequency));
+        if (!curPrediction.empty())
+        {
+            // the renderer reads at Now() + transmissionDelay, fade from there so a re-lock does not make the angle jump
+            newPrediction.crossFadeFrom(curPrediction, Clock::now() + _transmissionDelay, _ms_to_crossfade);
+        }
+        curPrediction = std::move(newPrediction);
+        consume(curPrediction, periodicity, lastPeriodBegin(), std::chrono::milliseconds(0), ""); // no overlay in non-calibration mode
+    }
+}
+
+/*
+* Takes the cycle between the last two zero crossings as template and starts with phase 0 at the last crossing,
+* then runs the filter over the samples received since then.
+*/
+bool PhaseLockedMovementPredictor::acquireLock(const TimeSeriesView& history)
+{
+    const auto& transitions = _periodicityTracker.transitions();
+    if (transitions.size() < 2)
+        return false;
+
+    auto begin = transitions[transitions.size() - 2];
+    auto end = transitions[transitions.size() - 1];
+    auto period = end - begin;
+    if (period < minPeriodicity || period > maxPeriodicity || history.empty() || history.time(0) > begin)
+        return false;
+
+    UniformTimeSeries cycle = history.slice(begin, end).resample();
+    if (cycle.size() < 2)
+        return false;
+
+    for (size_t k = 0; k < _template.size(); k++)
+    {
+        double pos = (double)k * (double)(cycle.size() - 1) / (double)_template.size();
+        size_t index = std::min((size_t)pos, cycle.size() - 2);
+        float weight = (float)(pos - (double)index);
+        _template[k] = cycle.angle(index) + (cycle.angle(index + 1) - cycle.angle(index)) * weight;
+    }
+
+    _phase = 0.0;
+    _frequency = 1.0 / (double)period.count();
+    _stateTime = end;
+    _p00 = std::pow(2.0 * _frequency, 2.0); // about 2 ms
+    _p01 = 0.0;
+    _p11 = std::pow(0.05 * _frequency, 2.0);
+    _innovationLevel = 0.0;
+    _locked = true;
+
+    auto next = history.upperBound(end);
+    for (size_t i = next; i < history.size(); i++)
+        updateState(history.angle(i), history.time(i));
+
+    AsyncLog::info("phase locked, period: {}", period.count());
+    return true;
+}
+
+float PhaseLockedMovementPredictor::templateAngle(double phase, float& slope) const
+{
+    double pos = phase * (double)_template.size();
+    size_t index = std::min((size_t)pos, _template.size() - 1);
+    float weight = (float)(pos - (double)index);
+    float next = _template[(index + 1) % _template.size()];
+
+    // slope in deg per cycle
+    slope = (next - _template[index]) * (float)_template.size();
+    return _template[index] + (next - _template[index]) * weight;
+}
+
+void PhaseLockedMovementPredictor::updateState(float angle, TimeSeries::Timestamp time)
+{
+    double dt = (double)(time - _stateTime).count();
+    if (dt < 0.0)
+        return;
+
+    // prediction: constant frequency, the phase and the frequency do a random walk
+    _phase += _frequency * dt;
+    _p00 += dt * (2.0 * _p01 + dt * _p11) + phaseNoise * dt + frequencyNoise * dt * dt * dt / 3.0;
+    _p01 += dt * _p11 + frequencyNoise * dt * dt / 2.0;
+    _p11 += frequencyNoise * dt;
+    _phase -= std::floor(_phase);
+
+    // correction with the template as measurement model, linearized at the predicted phase
+    float slope;
+    double expected = templateAngle(_phase, slope);
+    double innovation = angle - expected;
+    double innovationVariance = slope * slope * _p00 + measurementVariance;
+    double k0 = _p00 * slope / innovationVariance;
+    double k1 = _p01 * slope / innovationVariance;
+
+    _phase += k0 * innovation;
+    _frequency = std::clamp(_frequency + k1 * innovation, 1.0 / (double)maxPeriodicity.count(), 1.0 / (double)minPeriodicity.count());
+    double p00 = _p00, p01 = _p01;
+    _p00 -= k0 * slope * p00;
+    _p01 -= k0 * slope * p01;
+    _p11 -= k1 * slope * p01;
+    _phase -= std::floor(_phase);
+    _stateTime = time;
+
+    _innovationLevel += 0.01 * (innovation * innovation / innovationVariance - _innovationLevel);
+
+    // let the template follow slow changes of the wave form
+    size_t bin = std::min((size_t)std::lround(_phase * (double)_template.size()), _template.size()) % _template.size();
+    _template[bin] += templateAdaption * (angle - _template[bin]);
+}
+
+TimeSeries::Timestamp PhaseLockedMovementPredictor::lastPeriodBegin() const
+{
+    return _stateTime - std::chrono::milliseconds(std::llround(_phase / _frequency));
+}
+
+std::optional<std::tuple<std::chrono::milliseconds, TimeSeries::Timestamp>> PhaseLockedMovementPredictor::calcPeriodicity(const TimeSeriesView& ts)
+{
+    Tracer::Scope trace("periodicity");
+    _periodicityTracker.update(ts);
+    return _periodicityTracker.periodicity();
+}
+
+SampleQueue::WakeupEvent PhaseLockedMovementPredictor::wakeupEvent() const
+{
+    return SampleQueue::WakeupEvent::FallingZeroCrossing;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "AbstractMovementPredictor.h"
+#include "SinePeriodicityTracker.h"
+#include "RingTimeSeries.h"
+#include <vector>
+
+/*
+* Tracks the oil pump with a continuous phase / frequency state instead of copying and correlating the last cycle.
+* The state is updated per sample by an extended Kalman filter: the measurement model is a learned cycle template,
+* so the filter acts as a phase locked loop whose gains adapt to the slope of the signal at the current phase.
+* The template and the initial period are taken from the last two zero crossings, the lock is re-acquired that way
+* whenever the innovations stay too large.
+*/
+class PhaseLockedMovementPredictor : public AbstractMovementPredictor
+{
+public:
+	PhaseLockedMovementPredictor(Sensor& sensor, std::chrono::milliseconds ms_to_predict, std::chrono::milliseconds ms_to_crossfade, std::chrono::milliseconds transmissionDelay,
+		size_t templateSize = 512);
+
+	virtual void predictMovement(Sensor::Queue& inbound, ConsumeFunction consume, std::function<void(const std::string, TimeSeries&)> monitor);
+
+protected:
+	virtual std::optional<std::tuple<std::chrono::milliseconds, TimeSeries::Timestamp>> calcPeriodicity(const TimeSeriesView& ts);
+	virtual SampleQueue::WakeupEvent wakeupEvent() const;
+
+private:
+	void trackThread(Sensor::Queue& inbound, ConsumeFunction consume, std::function<void(const std::string, TimeSeries&)> monitor);
+	bool acquireLock(const TimeSeriesView& history);
+	void updateState(float angle, TimeSeries::Timestamp time);
+	float templateAngle(double phase, float& slope) const;
+	TimeSeries::Timestamp lastPeriodBegin() const;
+
+private:
+	SinePeriodicityTracker _periodicityTracker;
+	std::vector<float> _template;
+	bool _locked;
+
+	// state: phase in cycles [0, 1) and frequency in cycles per ms, at _stateTime
+	double _phase;
+	double _frequency;
+	TimeSeries::Timestamp _stateTime;
+	// covariance of the state
+	double _p00, _p01, _p11;
+	// running mean of the normalized squared innovations, to detect a lost lock
+	double _innovationLevel;
+};
+
@@ -0,0 +1,105 @@
+#include "PhaseModel.h"
+#include "Tracer.h"
+#include <cmath>
+#include <numbers>
+
+
+PhaseModel::PhaseModel(const TimeSeriesView& cycle)
+{
+    if (cycle.size() < 2)
+        return;
+
+    // the last sample is the first one of the next period
+    auto angles = cycle.angles();
+    _cycle = std::make_shared<const std::vector<float>>(angles.begin(), angles.end() - 1);
+    _anchor = cycle.time(0);
+    _period = Period((double)(cycle.size() - 1));
+}
+
+PhaseModel::PhaseModel(std::vector<float> cycle, Timestamp anchor, Period period)
+{
+    if (cycle.empty() || period.count() <= 0.0)
+        return;
+
+    _cycle = std::make_shared<const std::vector<float>>(std::move(cycle));
+    _anchor = anchor;
+    _period = period;
+}
+
+PhaseModel PhaseModel::fromHarmonics(std::vector<float> coefficients, Timestamp anchor, Period period)
+{
+    PhaseModel result(std::move(coefficients), anchor, period);
+    result._harmonic = true;
+    return result;
+}
+
+float PhaseModel::cycleAngleAt(Timestamp time) const
+{
+    const auto& cycle = *_cycle;
+    double elapsed = std::fmod((double)(time - _anchor).count(), _period.count());
+    if (elapsed < 0.0)
+        elapsed += _period.count();
+
+    if (_harmonic)
+    {
+        // cos / sin of the multiples of the phase by repeated rotation
+        double phase = 2.0 * std::numbers::pi * elapsed / _period.count();
+        double c1 = std::cos(phase), s1 = std::sin(phase);
+        double c = c1, s = s1;
+        double angle = cycle[0];
+        for (size_t i = 1; i + 1 < cycle.size(); i += 2)
+        {
+            angle += cycle[i] * c + cycle[i + 1] * s;
+            double next = c * c1 - s * s1;
+            s = s * c1 + c * s1;
+            c = next;
+        }
+        return (float)angle;
+    }
+
+    // linear interpolation between the neighbouring phases, exact for 1 ms cycles queried at full ms
+    double pos = elapsed * (double)cycle.size() / _period.count();
+    size_t index = std::min((size_t)pos, cycle.size() - 1);
+    float weight = (float)(pos - (double)index);
+    float next = cycle[(index + 1) % cycle.size()];
+    return cycle[index] + (next - cycle[index]) * weight;
+}
+
+float PhaseModel::angleAt(Timestamp time) const
+{
+    if (empty())
+        return 0.0f;
+
+    if (!_from || time >= _fadeBegin + _fadeDuration)
+        return cycleAngleAt(time);
+    if (time <= _fadeBegin)
+        return _from->angleAt(time);
+
+    float fadeIn = (float)(time - _fadeBegin).count() / (float)_fadeDuration.count();
+    return _from->angleAt(time) * (1.0f - fadeIn) + cycleAngleAt(time) * fadeIn;
+}
+
+void PhaseModel::crossFadeFrom(const PhaseModel& from, Timestamp begin, std::chrono::milliseconds duration)
+{
+    Tracer::Scope trace("crossFade");
+    if (from.empty() || duration.count() <= 0)
+        return;
+
+    // a fade of the previous model can still be running at begin, older ones are dropped so the chain stays short
+    _from = std::make_shared<const PhaseModel>(from.withoutFadesBefore(begin));
+    _fadeBegin = begin;
+    _fadeDuration = duration;
+}
+
+PhaseModel PhaseModel::withoutFadesBefore(Timestamp time) const
+{
+    PhaseModel result = *this;
+    if (!_from)
+        return result;
+
+    if (_fadeBegin + _fadeDuration <= time)
+        result._from.reset();
+    else
+        result._from = std::make_shared<const PhaseModel>(_from->withoutFadesBefore(time));
+    return result;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "TimeSeriesView.h"
+
+/*
+* Compact prediction: one cycle of the signal, continued periodically in both directions.
+* The cycle is either a template of angles at evenly spaced phases or the coefficients of a Fourier series.
+* Any timestamp is evaluated in O(1), so the cost does not depend on how far ahead the renderer looks.
+* A new model can be cross faded in from the previous one, the previous model is shared, not copied.
+*/
+class PhaseModel
+{
+public:
+	typedef TimeSeriesView::Timestamp Timestamp;
+	typedef std::chrono::duration<double, std::milli> Period;
+
+	PhaseModel() = default;
+	// cycle: evenly spaced 1 ms samples of exactly one period, the first and the last sample are one period apart
+	PhaseModel(const TimeSeriesView& cycle);
+	// cycle: angles at evenly spaced phases of one period, the first one is at anchor
+	PhaseModel(std::vector<float> cycle, Timestamp anchor, Period period);
+	// coefficients: a0, a1, b1, a2, b2, ... of a0 + sum of ak * cos(k * phase) + bk * sin(k * phase), phase 0 is at anchor
+	static PhaseModel fromHarmonics(std::vector<float> coefficients, Timestamp anchor, Period period);
+
+	bool empty() const
+	{
+		return !_cycle;
+	}
+	Period period() const
+	{
+		return _period;
+	}
+	// begin of the cycle, all multiples of the period before and after it are equivalent
+	Timestamp anchor() const
+	{
+		return _anchor;
+	}
+
+	float angleAt(Timestamp time) const;
+
+	// during [begin, begin + duration] the angle is faded linearly from the given model into this one
+	void crossFadeFrom(const PhaseModel& from, Timestamp begin, std::chrono::milliseconds duration);
+
+private:
+	float cycleAngleAt(Timestamp time) const;
+	// copy without the cross fades that are over at time
+	PhaseModel withoutFadesBefore(Timestamp time) const;
+
+private:
+	std::shared_ptr<const std::vector<float>> _cycle; // template or Fourier coefficients
+	bool _harmonic = false;
+	Timestamp _anchor;
+	Period _period = Period(0.0);
+
+	std::shared_ptr<const PhaseModel> _from;
+	Timestamp _fadeBegin;
+	std::chrono::milliseconds _fadeDuration = std::chrono::milliseconds(0);
+};
+
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <chrono>
+#include "TimeSeries.h"
+#include "PhaseModel.h"
+
+/*
+* Everything the renderer needs from one predictor cycle, published as a whole so the values always belong together.
+*/
+struct PredictionSnapshot
+{
+	PhaseModel model;
+	std::chrono::milliseconds periodicity = std::chrono::milliseconds(0);
+	TimeSeries::Timestamp lastPeriodBegin;
+	std::chrono::milliseconds curRoationOffset = std::chrono::milliseconds(0);
+};
+
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "TimeSeries.h"
+#include "PhaseModel.h"
 #include <functional>
 #include <chrono>
 #include <string>
@@ -13,7 +14,7 @@ public:
 	{
 
 	}
-	virtual void feedData(const TimeSeries& ts, std::chrono::milliseconds periodicity, TimeSeries::Timestamp, std::chrono::milliseconds, const std::string& overlay) = 0;
+	virtual void feedData(const PhaseModel& model, std::chrono::milliseconds periodicity, TimeSeries::Timestamp, std::chrono::milliseconds, const std::string& overlay) = 0;
 	virtual void render(std::function<void(const std::string, TimeSeries&)> monitor) = 0;
 	virtual void shutdown() = 0;
 };
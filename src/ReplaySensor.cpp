@@ -1,97 +1,103 @@
 #include "ReplaySensor.h"
-#include <iostream>
-#include <fstream>
-#include <boost/date_time/posix_time/posix_time.hpp>
-#include <boost/algorithm/string.hpp>
 #include <chrono>
-#include <tuple>
-#include <vector>
 #include "TimeSeries.h"
-#include <boost/log/trivial.hpp>
+#include "AsyncLog.h"
+#include "Clock.h"
+#include "Instrumentation.h"
+#include "Tracer.h"
 
 
-ReplaySensor::ReplaySensor(const std::string& fileName) : _shutdownRequested(false), _fileName(fileName)
+ReplaySensor::ReplaySensor(const std::string& fileName, std::chrono::milliseconds startOffset, std::chrono::microseconds spin) : _shutdownRequested(false),
+    _open(false),
+    _fileName(fileName),
+    _startOffset(startOffset),
+    _spin(spin)
 {
 }
 
 void ReplaySensor::replayThread(Sensor::Queue& queue)
 {
-    TimeSeries::Timestamp start_time = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now());
-
-    auto i = _data.begin();
-    while(i < _data.end() && !_shutdownRequested)
+    const auto maxSleep = std::chrono::milliseconds(100);
+    Tracer::setThreadName("sensor");
+
+    float angle = 0.0f;
+    TimeSeries::Timestamp time;
+    std::optional<SampleRecording::Cursor> cursor;
+    auto next = [&]() {
+        if (!cursor)
+            return _csv->next(angle, time);
+        if (!cursor->next())
+            return false;
+        angle = cursor->angle();
+        time = cursor->time();
+        return true;
+    };
+
+    TimeSeries::Timestamp recording_start;
+    bool pending;
+    if (_csv)
     {
-        
-        auto& sample = *i;
-        float angle;
-        int dummy;
-        TimeSeries::Timestamp time_point;
-        std::tie(angle, time_point, dummy) = sample;
-        time_point = time_point - std::get<1>(_data[0]) + start_time;
-
-        // Wait for 10 ms interval
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-
-        // Rebase the timestamp
-        TimeSeries::Timestamp curSlice = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now());
+        // CSV files are parsed while replaying and have no index, skip up to the start
+        pending = next();
+        recording_start = time + _startOffset;
+        while (pending && time < recording_start)
+            pending = next();
+    }
+    else
+    {
+        if (_recording.empty())
+            return;
+        recording_start = _recording.start() + _startOffset;
+        cursor = _recording.seek(recording_start);
+        pending = next();
+    }
 
-        // Replay all samples older than the current reference time within the 10 ms interval
-        while (time_point <= curSlice && i < _data.end() && !_shutdownRequested)
+    TimeSeries::Timestamp start_time = Clock::now();
+    while (pending && !_shutdownRequested)
+    {
+        // release the next sample at its original time relative to the start, gaps are slept in steps to stay responsive to shutdown
+        TimeSeries::Timestamp release = time - recording_start + start_time;
+        while (release - Clock::now() > maxSleep && !_shutdownRequested)
+            Clock::sleepFor(maxSleep);
+        Instrumentation::sensor.recordSchedulingError(Clock::sleepUntil(release, _spin));
+
+        // samples with the same timestamp are released together
+        Instrumentation::LoopTimer loopTimer(Instrumentation::sensor);
+        while (pending && time - recording_start + start_time <= release)
         {
-            
-            std::tie(angle, time_point, dummy) = *i;
-            time_point = time_point - std::get<1>(_data[0]) + start_time;
-            
-            if (!queue.push(TimeSeries::Sample(angle, time_point, 0)))
+            if (!queue.push(TimeSeries::Sample(angle, release, 0)))
             {
-                BOOST_LOG_TRIVIAL(info) << "inbound queue overflow" << std::endl;
+                AsyncLog::info("inbound queue overflow");
             }
-                
-            i++;        
+
+            pending = next();
         }
     }
+
+    if (_csv && _csv->invalidLines() > 0)
+        AsyncLog::info("skipped invalid lines of the replay file: {}", _csv->invalidLines());
 }
 
 
-void ReplaySensor::readFile()
+bool ReplaySensor::open()
 {
-    std::ifstream file(_fileName);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << _fileName << std::endl;
-        return;
-    }
-
-    std::string line;
-    while (std::getline(file, line)) {
-        std::vector<std::string> tokens;
-        boost::split(tokens, line, boost::is_any_of(","));
-
-        if (tokens.size() < 2) {
-            std::cerr << "Error: Invalid line in file" << std::endl;
-            continue; // skip this line
-        }
-
-        try {
-            float angle = std::stof(tokens[1]); // Convert string to float
-            long long milliseconds = std::stoll(tokens[0]); // Convert string to long long
-            //TimeSeries::Timestamp time_point = std::chrono::steady_clock::time_point(std::chrono::milliseconds(milliseconds));
-            TimeSeries::Timestamp time_point = std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds>(std::chrono::milliseconds(milliseconds));
-
-            _data.push_back(std::make_tuple(angle, time_point, 0)); // Store sample
-        }
-        catch (const std::exception& e) {
-            std::cerr << "Error: " << e.what() << std::endl;
-            continue; // skip this line
-        }
-    }
-    file.close();
+    if (SampleRecording::isRecording(_fileName))
+        _open = _recording.open(_fileName);
+    else
+        _open = _csv.emplace(_fileName).isOpen();
+    return _open;
 }
 
 
 void ReplaySensor::readData(Sensor::Queue& queue)
 {
-    readFile();
-    _replayThread = std::thread([this, &queue]() {
+    if (!_open && !open())
+    {
+        AsyncLog::info("could not open the replay file, nothing is replayed");
+        return;
+    }
+    _replayThread = std::thread([this, &queue, participant = Clock::Participant()]() {
+        participant.enter();
         replayThread(queue);
         });
     return;
@@ -100,5 +106,6 @@ void ReplaySensor::readData(Sensor::Queue& queue)
 void ReplaySensor::shutdown()
 {
     _shutdownRequested = true;
-    _replayThread.join();
+    if (_replayThread.joinable())
+        _replayThread.join();
 }
@@ -1,25 +1,41 @@
 #pragma once
 #include <atomic>
 #include "Sensor.h"
+#include "CsvSampleReader.h"
+#include "SampleRecording.h"
 #include "TimeSeries.h"
+#include <chrono>
+#include <optional>
 #include <thread>
 
 
+/*
+* Replays a binary SampleRecording (memory mapped) or a CSV recording (parsed while replaying) in real time,
+* starting startOffset after the first sample of the recording.
+* Every sample is released at its original time relative to the start with an absolute deadline sleep, the last spin
+* of it busy waiting. The scheduling error is recorded in Instrumentation::sensor.
+*/
 class ReplaySensor : public Sensor
 {
 public:
-	ReplaySensor(const std::string& fileName );
+	ReplaySensor(const std::string& fileName, std::chrono::milliseconds startOffset = std::chrono::milliseconds(0),
+		std::chrono::microseconds spin = std::chrono::microseconds(0));
+	// opens the recording, false if it cannot be read. Called by readData if it has not been called before
+	bool open();
 	virtual void readData(Queue& queue);
 	virtual void shutdown();
 
 private:
-	void readFile();
 	void replayThread(Sensor::Queue& queue);
 
 private:
 	std::atomic<bool> _shutdownRequested;
+	bool _open;
 	std::string _fileName;
-	std::vector<TimeSeries::Sample> _data;
+	std::chrono::milliseconds _startOffset;
+	std::chrono::microseconds _spin;
+	SampleRecording _recording;
+	std::optional<CsvSampleReader> _csv;
 	std::thread _replayThread;
 };
 
@@ -0,0 +1,73 @@
+#include "RingTimeSeries.h"
+#include <algorithm>
+
+
+RingTimeSeries::RingTimeSeries(size_t capacity) : _capacity(std::max<size_t>(capacity, 1)),
+    _head(0),
+    _size(0),
+    _angles(2 * _capacity),
+    _timestamps(2 * _capacity),
+    _frameIndices(2 * _capacity)
+{
+}
+
+void RingTimeSeries::add(const TimeSeries::Sample& sample)
+{
+    add(std::get<0>(sample), std::get<1>(sample), std::get<2>(sample));
+}
+
+void RingTimeSeries::add(float angle, TimeSeries::Timestamp time, int frameIndex)
+{
+    if (_size > 0 && time == timestamps()[_size - 1])
+    {
+        // replace the latest sample
+        _size--;
+    }
+    else if (_size == _capacity)
+    {
+        // overwrite the oldest sample
+        _head = (_head + 1) % _capacity;
+        _size--;
+    }
+
+    // write both mirrors, so the window [_head, _head + _size) is always contiguous
+    size_t slot = (_head + _size) % _capacity;
+    _angles[slot] = _angles[slot + _capacity] = angle;
+    _timestamps[slot] = _timestamps[slot + _capacity] = time;
+    _frameIndices[slot] = _frameIndices[slot + _capacity] = frameIndex;
+    _size++;
+}
+
+/* drops all samples older than start */
+void RingTimeSeries::dropBefore(const TimeSeries::Timestamp& start)
+{
+    auto count = view().lowerBound(start);
+    _head = (_head + count) % _capacity;
+    _size -= count;
+}
+
+void RingTimeSeries::clear()
+{
+    _head = 0;
+    _size = 0;
+}
+
+std::optional<size_t> RingTimeSeries::findIndex(const TimeSeries::Timestamp& timestamp) const
+{
+    return view().findIndex(timestamp);
+}
+
+TimeSeriesView RingTimeSeries::slice(const TimeSeries::Timestamp& start, const TimeSeries::Timestamp& end) const
+{
+    return view().slice(start, end);
+}
+
+UniformTimeSeries RingTimeSeries::resample() const
+{
+    return view().resample();
+}
+
+void RingTimeSeries::resampleIncremental(UniformTimeSeries& resampled) const
+{
+    view().resampleIncremental(resampled);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "TimeSeries.h"
+#include <vector>
+#include <optional>
+
+/*
+* Fixed capacity time series for a sliding window of samples, e.g. the inbound sensor data of the predictor.
+* Every sample is stored twice (mirrored ring), so the live window is always one contiguous range of each column.
+* Adding and dropping samples never allocates: once full, the oldest sample is overwritten.
+* Samples with the same timestamp as the latest one replace it (same result as TimeSeries::deduplicate).
+*/
+class RingTimeSeries
+{
+public:
+	RingTimeSeries(size_t capacity);
+
+	void add(const TimeSeries::Sample& sample);
+	void add(float angle, TimeSeries::Timestamp time, int frameIndex = 0);
+	void dropBefore(const TimeSeries::Timestamp& start);
+	void clear();
+
+	size_t size() const
+	{
+		return _size;
+	}
+	bool empty() const
+	{
+		return _size == 0;
+	}
+	size_t capacity() const
+	{
+		return _capacity;
+	}
+	float angle(size_t i) const
+	{
+		return angles()[i];
+	}
+	TimeSeries::Timestamp time(size_t i) const
+	{
+		return timestamps()[i];
+	}
+
+	// contiguous columns of the live window
+	const float* angles() const
+	{
+		return _angles.data() + _head;
+	}
+	const TimeSeries::Timestamp* timestamps() const
+	{
+		return _timestamps.data() + _head;
+	}
+	const int* frameIndices() const
+	{
+		return _frameIndices.data() + _head;
+	}
+
+	TimeSeriesView view() const
+	{
+		return TimeSeriesView(angles(), timestamps(), frameIndices(), _size);
+	}
+	operator TimeSeriesView() const
+	{
+		return view();
+	}
+
+	std::optional<size_t> findIndex(const TimeSeries::Timestamp& timestamp) const;
+	TimeSeriesView slice(const TimeSeries::Timestamp& start, const TimeSeries::Timestamp& end) const;
+	UniformTimeSeries resample() const;
+	void resampleIncremental(UniformTimeSeries& resampled) const;
+
+private:
+	size_t _capacity;
+	size_t _head;
+	size_t _size;
+	std::vector<float> _angles;
+	std::vector<TimeSeries::Timestamp> _timestamps;
+	std::vector<int> _frameIndices;
+};
+
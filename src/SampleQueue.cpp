@@ -0,0 +1,64 @@
+#include "SampleQueue.h"
+#include <algorithm>
+
+
+SampleQueue::SampleQueue() : _wakeupSamples(1),
+    _wakeupEvent(WakeupEvent::None),
+    _samplesSinceWakeup(0),
+    _prevAngle(0.0f),
+    _hasPrevAngle(false),
+    _wakeupPending(false)
+{
+}
+
+bool SampleQueue::push(const TimeSeries::Sample& sample)
+{
+    if (!_queue.push(sample))
+        return false;
+    Tracer::instant("push");
+
+    float angle = std::get<0>(sample);
+    bool event = false;
+    if (_hasPrevAngle)
+    {
+        switch (_wakeupEvent.load(std::memory_order_relaxed))
+        {
+        case WakeupEvent::FallingZeroCrossing:
+            event = _prevAngle > 0 && angle <= 0;
+            break;
+        case WakeupEvent::WrapAround:
+            event = _prevAngle - angle > 180.0f;
+            break;
+        default:
+            break;
+        }
+    }
+    _prevAngle = angle;
+    _hasPrevAngle = true;
+
+    if (++_samplesSinceWakeup >= _wakeupSamples.load(std::memory_order_relaxed) || event)
+    {
+        _samplesSinceWakeup = 0;
+        notify();
+    }
+    return true;
+}
+
+bool SampleQueue::waitForSamples(std::chrono::milliseconds maxInterval)
+{
+    bool woken = Clock::waitFor(maxInterval, [this] { return _wakeupPending.load(); });
+    _wakeupPending = false;
+    return woken;
+}
+
+void SampleQueue::setWakeup(size_t samples, WakeupEvent event)
+{
+    _wakeupSamples.store(std::max<size_t>(samples, 1), std::memory_order_relaxed);
+    _wakeupEvent.store(event, std::memory_order_relaxed);
+}
+
+void SampleQueue::notify()
+{
+    _wakeupPending = true;
+    Clock::notify();
+}
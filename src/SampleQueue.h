@@ -0,0 +1,63 @@
+#pragma once
+
+#include <boost/lockfree/spsc_queue.hpp>
+#include <atomic>
+#include <chrono>
+#include "Clock.h"
+#include "TimeSeries.h"
+#include "Tracer.h"
+
+/*
+* Single producer / single consumer sample queue that can wake up its consumer.
+* Pushing stays lock-free, the producer only takes the Clock mutex to signal a wake up: after a configurable number of samples
+* or on an event in the signal (e.g. a zero crossing), so the consumer reacts to new data instead of polling.
+* The wait goes through the Clock, so the virtual clock can step producer and consumer.
+*/
+class SampleQueue
+{
+public:
+	enum class WakeupEvent
+	{
+		None,
+		FallingZeroCrossing, // angle goes from positive to non-positive (oil pump)
+		WrapAround // angle jumps from close to 360 to close to 0 (wheel)
+	};
+
+	SampleQueue();
+
+	// producer side
+	bool push(const TimeSeries::Sample& sample);
+
+	// consumer side
+	template <typename Functor>
+	size_t consume_all(const Functor& f)
+	{
+		Tracer::Scope trace("consume");
+		return _queue.consume_all(f);
+	}
+	size_t read_available() const
+	{
+		return _queue.read_available();
+	}
+	// blocks until a wake up was signalled or maxInterval (Clock time) has passed, returns false on timeout
+	bool waitForSamples(std::chrono::milliseconds maxInterval);
+
+	// can be changed while the producer is running
+	void setWakeup(size_t samples, WakeupEvent event);
+	// wakes the consumer immediately, e.g. on shutdown
+	void notify();
+
+private:
+	boost::lockfree::spsc_queue<TimeSeries::Sample, boost::lockfree::capacity<500>> _queue;
+
+	std::atomic<size_t> _wakeupSamples;
+	std::atomic<WakeupEvent> _wakeupEvent;
+
+	// producer only
+	size_t _samplesSinceWakeup;
+	float _prevAngle;
+	bool _hasPrevAngle;
+
+	std::atomic<bool> _wakeupPending;
+};
+
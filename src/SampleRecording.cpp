@@ -0,0 +1,236 @@
+#include "SampleRecording.h"
+#include "CsvSampleReader.h"
+#include <boost/interprocess/file_mapping.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+
+namespace
+{
+    void writeVarint(std::vector<std::byte>& out, int64_t value)
+    {
+        uint64_t zigzag = (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+        while (zigzag >= 0x80)
+        {
+            out.push_back(std::byte(zigzag | 0x80));
+            zigzag >>= 7;
+        }
+        out.push_back(std::byte(zigzag));
+    }
+
+    // false if the varint runs past end or is longer than 10 bytes
+    bool readVarint(const std::byte*& in, const std::byte* end, int64_t& value)
+    {
+        uint64_t zigzag = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (in >= end)
+                return false;
+            uint8_t b = uint8_t(*in++);
+            zigzag |= uint64_t(b & 0x7f) << shift;
+            if (!(b & 0x80))
+            {
+                value = int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename T>
+    void writeRaw(std::vector<std::byte>& out, const T& value)
+    {
+        auto bytes = reinterpret_cast<const std::byte*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+}
+
+
+SampleRecording::Cursor::Cursor(const SampleRecording& recording, const IndexEntry& entry) : _recording(&recording),
+    _position(recording._data + entry.offset),
+    _next(entry.sample),
+    _time(entry.time),
+    _angle(0.0f)
+{
+}
+
+bool SampleRecording::Cursor::next()
+{
+    if (atEnd())
+        return false;
+
+    int64_t delta;
+    const std::byte* end = _recording->samplesEnd();
+    if (!readVarint(_position, end, delta) || end - _position < (ptrdiff_t)sizeof(float))
+    {
+        // corrupt sample, the recording ends here
+        _next = _recording->size();
+        return false;
+    }
+    _time += delta;
+    std::memcpy(&_angle, _position, sizeof(float));
+    _position += sizeof(float);
+    _next++;
+    return true;
+}
+
+bool SampleRecording::open(const std::string& fileName)
+{
+    try
+    {
+        boost::interprocess::file_mapping file(fileName.c_str(), boost::interprocess::read_only);
+        _region = boost::interprocess::mapped_region(file, boost::interprocess::read_only);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: Could not map file " << fileName << ": " << e.what() << std::endl;
+        return false;
+    }
+    return attach(static_cast<const std::byte*>(_region.get_address()), _region.get_size());
+}
+
+bool SampleRecording::attach(const std::byte* data, size_t size)
+{
+    _data = nullptr;
+    _header = nullptr;
+
+    auto header = reinterpret_cast<const Header*>(data);
+    if (size < sizeof(Header) || std::memcmp(header->magic, magic, sizeof(magic)) != 0 || header->version != version)
+    {
+        std::cerr << "Error: Not a sample recording" << std::endl;
+        return false;
+    }
+    if (!validate(data, size, *header))
+    {
+        std::cerr << "Error: Truncated or corrupt sample recording" << std::endl;
+        return false;
+    }
+
+    _data = data;
+    _header = header;
+    return true;
+}
+
+/*
+* Checks that the index lies within the file and matches the sample count, and that the samples of each index entry
+* fit between its offset and the next one (at least one varint byte and the angle per sample).
+* The deltas themselves are only checked while decoding.
+*/
+bool SampleRecording::validate(const std::byte* data, size_t size, const Header& header)
+{
+    const uint64_t minSampleSize = 1 + sizeof(float);
+    if (header.indexOffset < sizeof(Header) || header.indexOffset > size || header.indexOffset % alignof(IndexEntry) != 0)
+        return false;
+    if (header.indexCount > (size - header.indexOffset) / sizeof(IndexEntry) || header.indexInterval == 0)
+        return false;
+    if (header.indexCount != header.sampleCount / header.indexInterval + (header.sampleCount % header.indexInterval != 0))
+        return false;
+
+    auto entries = reinterpret_cast<const IndexEntry*>(data + header.indexOffset);
+    for (uint64_t k = 0; k < header.indexCount; k++)
+    {
+        uint64_t end = k + 1 < header.indexCount ? entries[k + 1].offset : header.indexOffset;
+        uint64_t samples = std::min<uint64_t>(header.indexInterval, header.sampleCount - k * header.indexInterval);
+        if (entries[k].sample != k * header.indexInterval || entries[k].offset < sizeof(Header) || entries[k].offset > end)
+            return false;
+        if ((end - entries[k].offset) / minSampleSize < samples)
+            return false;
+    }
+    return true;
+}
+
+SampleRecording::Cursor SampleRecording::begin() const
+{
+    if (empty())
+        return Cursor(*this, IndexEntry{ 0, 0, sizeof(Header) });
+    return Cursor(*this, index()[0]);
+}
+
+SampleRecording::Cursor SampleRecording::seek(const TimeSeries::Timestamp& time) const
+{
+    if (empty())
+        return begin();
+
+    // last index entry whose base time (time of the sample before it) is before time, then decode at most indexInterval samples
+    int64_t ms = time.time_since_epoch().count();
+    auto first = index();
+    auto last = first + _header->indexCount;
+    auto entry = std::lower_bound(first, last, ms, [](const IndexEntry& e, int64_t t) { return e.time < t; });
+    if (entry != first)
+        entry--;
+
+    Cursor cursor(*this, *entry);
+    Cursor ahead = cursor;
+    while (ahead.next() && ahead.time() < time)
+        cursor = ahead;
+    return cursor;
+}
+
+bool SampleRecording::isRecording(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    char fileMagic[sizeof(magic)] = {};
+    file.read(fileMagic, sizeof(fileMagic));
+    return file && std::memcmp(fileMagic, magic, sizeof(magic)) == 0;
+}
+
+std::vector<std::byte> SampleRecording::encode(const TimeSeriesView& samples)
+{
+    Header header = {};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.indexInterval = indexInterval;
+    header.sampleCount = samples.size();
+    if (!samples.empty())
+    {
+        header.firstTime = samples.time(0).time_since_epoch().count();
+        header.lastTime = samples.time(samples.size() - 1).time_since_epoch().count();
+    }
+
+    std::vector<std::byte> out;
+    out.reserve(sizeof(Header) + samples.size() * 6);
+    writeRaw(out, header);
+
+    std::vector<IndexEntry> entries;
+    int64_t previous = header.firstTime;
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        if (i % indexInterval == 0)
+            entries.push_back({ previous, i, out.size() });
+
+        int64_t time = samples.time(i).time_since_epoch().count();
+        writeVarint(out, time - previous);
+        writeRaw(out, samples.angle(i));
+        previous = time;
+    }
+
+    // the index entries are read in place, align them
+    out.resize((out.size() + alignof(IndexEntry) - 1) / alignof(IndexEntry) * alignof(IndexEntry));
+    header.indexOffset = out.size();
+    header.indexCount = entries.size();
+    for (const auto& entry : entries)
+        writeRaw(out, entry);
+    std::memcpy(out.data(), &header, sizeof(Header));
+    return out;
+}
+
+bool SampleRecording::write(const std::string& fileName, const TimeSeriesView& samples)
+{
+    auto bytes = encode(samples);
+    std::ofstream file(fileName, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    if (!file)
+    {
+        std::cerr << "Error: Could not write file " << fileName << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool SampleRecording::convertCsv(const std::string& csvFileName, const std::string& fileName)
+{
+    auto samples = CsvSampleReader::load(csvFileName);
+    return samples && write(fileName, *samples);
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "TimeSeries.h"
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+* Binary sensor recording for the ReplaySensor. Layout (little endian):
+*   Header
+*   samples: zigzag varint of the timestamp delta to the previous sample in ms, followed by the angle as raw float
+*   index: one IndexEntry every indexInterval samples, for seeking without decoding the whole file
+* The file is memory mapped, opening it only reads the header, samples are decoded while streaming.
+* CSV recordings (see CsvSampleReader) can be converted with convertCsv.
+*/
+class SampleRecording
+{
+public:
+	static constexpr char magic[8] = { 'P', 'J', 'S', 'A', 'M', 'P', 'L', 'E' };
+	static constexpr uint32_t version = 1;
+	static constexpr uint32_t indexInterval = 1024;
+
+	struct Header
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t indexInterval;
+		uint64_t sampleCount;
+		int64_t firstTime; // ms
+		int64_t lastTime; // ms
+		uint64_t indexOffset; // bytes from the start of the file
+		uint64_t indexCount;
+	};
+
+	struct IndexEntry
+	{
+		int64_t time; // ms
+		uint64_t sample;
+		uint64_t offset; // bytes from the start of the file, the delta of this sample is relative to time
+	};
+
+	// forward iterator over the samples
+	class Cursor
+	{
+	public:
+		bool atEnd() const
+		{
+			return _next >= _recording->size();
+		}
+		TimeSeries::Timestamp time() const
+		{
+			return TimeSeries::Timestamp(std::chrono::milliseconds(_time));
+		}
+		float angle() const
+		{
+			return _angle;
+		}
+		// index of the sample next() reads
+		size_t position() const
+		{
+			return _next;
+		}
+		// decodes the next sample, false at the end of the recording
+		bool next();
+
+	private:
+		friend class SampleRecording;
+		Cursor(const SampleRecording& recording, const IndexEntry& entry);
+
+		const SampleRecording* _recording;
+		const std::byte* _position;
+		size_t _next;
+		int64_t _time;
+		float _angle;
+	};
+
+	// empty recording, open() maps a file
+	SampleRecording() = default;
+	SampleRecording(const SampleRecording&) = delete;
+	SampleRecording& operator=(const SampleRecording&) = delete;
+
+	// maps a binary recording, false if the file cannot be mapped or is no recording
+	bool open(const std::string& fileName);
+
+	size_t size() const
+	{
+		return _header ? _header->sampleCount : 0;
+	}
+	bool empty() const
+	{
+		return size() == 0;
+	}
+	TimeSeries::Timestamp start() const
+	{
+		return TimeSeries::Timestamp(std::chrono::milliseconds(_header->firstTime));
+	}
+	TimeSeries::Timestamp end() const
+	{
+		return TimeSeries::Timestamp(std::chrono::milliseconds(_header->lastTime));
+	}
+
+	// positioned before the first sample, call next() to read it
+	Cursor begin() const;
+	// positioned before the first sample at or after time
+	Cursor seek(const TimeSeries::Timestamp& time) const;
+
+	static bool isRecording(const std::string& fileName);
+	static std::vector<std::byte> encode(const TimeSeriesView& samples);
+	static bool write(const std::string& fileName, const TimeSeriesView& samples);
+	static bool convertCsv(const std::string& csvFileName, const std::string& fileName);
+
+private:
+	bool attach(const std::byte* data, size_t size);
+	static bool validate(const std::byte* data, size_t size, const Header& header);
+	const IndexEntry* index() const
+	{
+		return reinterpret_cast<const IndexEntry*>(_data + _header->indexOffset);
+	}
+	// the samples end where the index begins
+	const std::byte* samplesEnd() const
+	{
+		return _data + _header->indexOffset;
+	}
+
+private:
+	boost::interprocess::mapped_region _region;
+	const std::byte* _data = nullptr;
+	const Header* _header = nullptr;
+};
+
@@ -0,0 +1,311 @@
+#include "SimdKernels.h"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SIMD_TARGET_AVX2
+#else
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+    /* scalar reference implementations, also used for the tails of the vectorized loops */
+
+    float scalarSumOfSquaredDifferences(const float* a, const float* b, size_t n)
+    {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i)
+        {
+            float diff = a[i] - b[i];
+            sum += diff * diff;
+        }
+        return sum;
+    }
+
+    float crossFadeStep(size_t n)
+    {
+        return n > 1 ? 1.0f / (float)(n - 1) : 1.0f;
+    }
+
+    void scalarCrossFade(const float* fadeOut, const float* fadeIn, float* out, size_t begin, size_t n, float step)
+    {
+        for (size_t i = begin; i < n; ++i)
+        {
+            float fadeInWeight = (float)i * step;
+            float fadeOutWeight = 1.0f - fadeInWeight;
+            out[i] = fadeOut[i] * fadeOutWeight + fadeIn[i] * fadeInWeight;
+        }
+    }
+
+    float scalarInterpolateAngle(float angleLower, float angleUpper, float distanceLower, float distanceUpper)
+    {
+        // Handle rollover
+        if (std::abs(angleUpper - angleLower) > 180) {
+            if (angleLower > angleUpper) {
+                angleUpper += 360;
+            }
+            else {
+                angleLower += 360;
+            }
+        }
+
+        float interpolated = (angleLower * distanceUpper + angleUpper * distanceLower) / (distanceLower + distanceUpper);
+        if (interpolated >= 360)
+            interpolated -= 360;
+        return interpolated;
+    }
+
+    void scalarInterpolateAngles(const float* lower, const float* upper, const float* lowerDistance, const float* upperDistance, float* out, size_t begin, size_t n)
+    {
+        for (size_t i = begin; i < n; ++i)
+            out[i] = scalarInterpolateAngle(lower[i], upper[i], lowerDistance[i], upperDistance[i]);
+    }
+
+#ifdef SIMD_KERNELS_X86
+
+    /* SSE2, always available on x86-64 */
+
+    float sse2SumOfSquaredDifferences(const float* a, const float* b, size_t n)
+    {
+        __m128 sum0 = _mm_setzero_ps();
+        __m128 sum1 = _mm_setzero_ps();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128 d0 = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+            __m128 d1 = _mm_sub_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4));
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(d0, d0));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(d1, d1));
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, _mm_add_ps(sum0, sum1));
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + scalarSumOfSquaredDifferences(a + i, b + i, n - i);
+    }
+
+    void sse2CrossFade(const float* fadeOut, const float* fadeIn, float* out, size_t n)
+    {
+        float step = crossFadeStep(n);
+        __m128 steps = _mm_set1_ps(step);
+        __m128 ones = _mm_set1_ps(1.0f);
+        __m128 index = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        __m128 four = _mm_set1_ps(4.0f);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 fadeInWeight = _mm_mul_ps(index, steps);
+            __m128 fadeOutWeight = _mm_sub_ps(ones, fadeInWeight);
+            __m128 blended = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(fadeOut + i), fadeOutWeight), _mm_mul_ps(_mm_loadu_ps(fadeIn + i), fadeInWeight));
+            _mm_storeu_ps(out + i, blended);
+            index = _mm_add_ps(index, four);
+        }
+        scalarCrossFade(fadeOut, fadeIn, out, i, n, step);
+    }
+
+    void sse2InterpolateAngles(const float* lower, const float* upper, const float* lowerDistance, const float* upperDistance, float* out, size_t n)
+    {
+        const __m128 full = _mm_set1_ps(360.0f);
+        const __m128 half = _mm_set1_ps(180.0f);
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 angleLower = _mm_loadu_ps(lower + i);
+            __m128 angleUpper = _mm_loadu_ps(upper + i);
+            __m128 distanceLower = _mm_loadu_ps(lowerDistance + i);
+            __m128 distanceUpper = _mm_loadu_ps(upperDistance + i);
+
+            // roll over: 360 is added to the smaller angle
+            __m128 rollover = _mm_cmpgt_ps(_mm_and_ps(_mm_sub_ps(angleUpper, angleLower), absMask), half);
+            __m128 lowerIsLarger = _mm_cmpgt_ps(angleLower, angleUpper);
+            angleUpper = _mm_add_ps(angleUpper, _mm_and_ps(_mm_and_ps(rollover, lowerIsLarger), full));
+            angleLower = _mm_add_ps(angleLower, _mm_and_ps(_mm_andnot_ps(lowerIsLarger, rollover), full));
+
+            __m128 interpolated = _mm_div_ps(_mm_add_ps(_mm_mul_ps(angleLower, distanceUpper), _mm_mul_ps(angleUpper, distanceLower)), _mm_add_ps(distanceLower, distanceUpper));
+            interpolated = _mm_sub_ps(interpolated, _mm_and_ps(_mm_cmpge_ps(interpolated, full), full));
+            _mm_storeu_ps(out + i, interpolated);
+        }
+        scalarInterpolateAngles(lower, upper, lowerDistance, upperDistance, out, i, n);
+    }
+
+    /* AVX2, compiled for that target only, called only if the CPU supports it */
+
+    SIMD_TARGET_AVX2 float avx2SumOfSquaredDifferences(const float* a, const float* b, size_t n)
+    {
+        __m256 sum0 = _mm256_setzero_ps();
+        __m256 sum1 = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+            __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+            sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(d0, d0));
+            sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(d1, d1));
+        }
+        __m256 sum = _mm256_add_ps(sum0, sum1);
+        __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        float lanes[4];
+        _mm_storeu_ps(lanes, sum4);
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + scalarSumOfSquaredDifferences(a + i, b + i, n - i);
+    }
+
+    SIMD_TARGET_AVX2 void avx2CrossFade(const float* fadeOut, const float* fadeIn, float* out, size_t n)
+    {
+        float step = crossFadeStep(n);
+        __m256 steps = _mm256_set1_ps(step);
+        __m256 ones = _mm256_set1_ps(1.0f);
+        __m256 index = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+        __m256 eight = _mm256_set1_ps(8.0f);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256 fadeInWeight = _mm256_mul_ps(index, steps);
+            __m256 fadeOutWeight = _mm256_sub_ps(ones, fadeInWeight);
+            __m256 blended = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(fadeOut + i), fadeOutWeight), _mm256_mul_ps(_mm256_loadu_ps(fadeIn + i), fadeInWeight));
+            _mm256_storeu_ps(out + i, blended);
+            index = _mm256_add_ps(index, eight);
+        }
+        scalarCrossFade(fadeOut, fadeIn, out, i, n, step);
+    }
+
+    SIMD_TARGET_AVX2 void avx2InterpolateAngles(const float* lower, const float* upper, const float* lowerDistance, const float* upperDistance, float* out, size_t n)
+    {
+        const __m256 full = _mm256_set1_ps(360.0f);
+        const __m256 half = _mm256_set1_ps(180.0f);
+        const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256 angleLower = _mm256_loadu_ps(lower + i);
+            __m256 angleUpper = _mm256_loadu_ps(upper + i);
+            __m256 distanceLower = _mm256_loadu_ps(lowerDistance + i);
+            __m256 distanceUpper = _mm256_loadu_ps(upperDistance + i);
+
+            // roll over: 360 is added to the smaller angle
+            __m256 rollover = _mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(angleUpper, angleLower), absMask), half, _CMP_GT_OQ);
+            __m256 lowerIsLarger = _mm256_cmp_ps(angleLower, angleUpper, _CMP_GT_OQ);
+            angleUpper = _mm256_add_ps(angleUpper, _mm256_and_ps(_mm256_and_ps(rollover, lowerIsLarger), full));
+            angleLower = _mm256_add_ps(angleLower, _mm256_and_ps(_mm256_andnot_ps(lowerIsLarger, rollover), full));
+
+            __m256 interpolated = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(angleLower, distanceUpper), _mm256_mul_ps(angleUpper, distanceLower)), _mm256_add_ps(distanceLower, distanceUpper));
+            interpolated = _mm256_sub_ps(interpolated, _mm256_and_ps(_mm256_cmp_ps(interpolated, full, _CMP_GE_OQ), full));
+            _mm256_storeu_ps(out + i, interpolated);
+        }
+        scalarInterpolateAngles(lower, upper, lowerDistance, upperDistance, out, i, n);
+    }
+
+    bool cpuSupportsAvx2()
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6; // OSXSAVE and XMM/YMM state enabled
+        __cpuidex(info, 7, 0);
+        return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+#endif
+
+    float dispatchSumOfSquaredDifferences(const float* a, const float* b, size_t n)
+    {
+        return scalarSumOfSquaredDifferences(a, b, n);
+    }
+
+    void dispatchCrossFade(const float* fadeOut, const float* fadeIn, float* out, size_t n)
+    {
+        scalarCrossFade(fadeOut, fadeIn, out, 0, n, crossFadeStep(n));
+    }
+
+    void dispatchInterpolateAngles(const float* lower, const float* upper, const float* lowerDistance, const float* upperDistance, float* out, size_t n)
+    {
+        scalarInterpolateAngles(lower, upper, lowerDistance, upperDistance, out, 0, n);
+    }
+
+    struct Kernels
+    {
+        SimdKernels::Level level;
+        float (*sumOfSquaredDifferences)(const float*, const float*, size_t);
+        void (*crossFade)(const float*, const float*, float*, size_t);
+        void (*interpolateAngles)(const float*, const float*, const float*, const float*, float*, size_t);
+    };
+
+    Kernels kernelsFor(SimdKernels::Level level)
+    {
+#ifdef SIMD_KERNELS_X86
+        if (level == SimdKernels::Level::AVX2)
+            return { level, avx2SumOfSquaredDifferences, avx2CrossFade, avx2InterpolateAngles };
+        if (level == SimdKernels::Level::SSE2)
+            return { level, sse2SumOfSquaredDifferences, sse2CrossFade, sse2InterpolateAngles };
+#endif
+        return { SimdKernels::Level::Scalar, dispatchSumOfSquaredDifferences, dispatchCrossFade, dispatchInterpolateAngles };
+    }
+
+    SimdKernels::Level detectLevel()
+    {
+#ifdef SIMD_KERNELS_X86
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+        return cpuSupportsAvx2() ? SimdKernels::Level::AVX2 : SimdKernels::Level::SSE2;
+#else
+        return cpuSupportsAvx2() ? SimdKernels::Level::AVX2 : SimdKernels::Level::Scalar;
+#endif
+#else
+        return SimdKernels::Level::Scalar;
+#endif
+    }
+
+    Kernels& currentKernels()
+    {
+        static Kernels kernels = kernelsFor(SimdKernels::supportedLevel());
+        return kernels;
+    }
+}
+
+
+SimdKernels::Level SimdKernels::supportedLevel()
+{
+    static const Level supported = detectLevel();
+    return supported;
+}
+
+SimdKernels::Level SimdKernels::level()
+{
+    return currentKernels().level;
+}
+
+void SimdKernels::setLevel(Level level)
+{
+    if (level > supportedLevel())
+        level = supportedLevel();
+    currentKernels() = kernelsFor(level);
+}
+
+float SimdKernels::sumOfSquaredDifferences(const float* a, const float* b, size_t n)
+{
+    return currentKernels().sumOfSquaredDifferences(a, b, n);
+}
+
+void SimdKernels::crossFade(const float* fadeOut, const float* fadeIn, float* out, size_t n)
+{
+    // a single sample is taken from fadeIn completely
+    if (n == 1)
+    {
+        out[0] = fadeIn[0];
+        return;
+    }
+    currentKernels().crossFade(fadeOut, fadeIn, out, n);
+}
+
+void SimdKernels::interpolateAngles(const float* lower, const float* upper, const float* lowerDistance, const float* upperDistance, float* out, size_t n)
+{
+    currentKernels().interpolateAngles(lower, upper, lowerDistance, upperDistance, out, n);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+* Vectorized inner loops of the time series algorithms, with SSE2 and AVX2 variants selected at runtime by CPUID.
+* Every kernel has a scalar fallback with the same operation order, the SIMD variants only change the summation order of reductions.
+*/
+class SimdKernels
+{
+public:
+	enum class Level
+	{
+		Scalar,
+		SSE2,
+		AVX2
+	};
+
+	// best level supported by this CPU, and the level currently used
+	static Level supportedLevel();
+	static Level level();
+	// restricts the kernels to a lower level, e.g. to compare against the scalar results. Not thread safe
+	static void setLevel(Level level);
+
+	// sum of (a[i] - b[i])^2
+	static float sumOfSquaredDifferences(const float* a, const float* b, size_t n);
+	// out[i] = fadeOut[i] * (1 - w) + fadeIn[i] * w with w rising linearly from 0 to 1 over the n samples
+	static void crossFade(const float* fadeOut, const float* fadeIn, float* out, size_t n);
+	// angles between lower and upper, weighted by the distances to them, across the 360 -> 0 roll over (see TimeSeries::interpolateAngle)
+	static void interpolateAngles(const float* lower, const float* upper, const float* lowerDistance, const float* upperDistance, float* out, size_t n);
+};
+
@@ -1,5 +1,8 @@
 #include "SimulationSensor.h"
-#include <boost/log/trivial.hpp>
+#include "AsyncLog.h"
+#include "Clock.h"
+#include "Instrumentation.h"
+#include "Tracer.h"
 #include <numbers>
 //#include "windows.h"
 #include <cmath>
@@ -11,7 +14,8 @@ SimulationSensor::SimulationSensor() : _shutdownRequested(false)
 
 void SimulationSensor::readData(Queue& queue)
 {
-    _thread = std::thread([this, &queue]() {
+    _thread = std::thread([this, &queue, participant = Clock::Participant()]() {
+        participant.enter();
         simulateThread(queue);
         });
 }
@@ -24,18 +28,20 @@ void SimulationSensor::shutdown()
 
 void SimulationSensor::simulateThread(Sensor::Queue& queue)
 {
+    Tracer::setThreadName("sensor");
     // Set the periodicity in seconds
     double p = 3;
 
     // Get the reference time before entering the loop
-    auto reference_time = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now());
+    auto reference_time = Clock::now();
 
     auto prevTime = reference_time;
 
     while (!_shutdownRequested) {
         // Get the current absolute time
-        auto current_time = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now());
+        auto current_time = Clock::now();
 
+        Instrumentation::LoopTimer loopTimer(Instrumentation::sensor);
         auto simTime = prevTime;
         while (simTime <= current_time)
         {
@@ -45,17 +51,18 @@ void SimulationSensor::simulateThread(Sensor::Queue& queue)
 
             if (!queue.push({ value, simTime, 0 }))
             {
-                BOOST_LOG_TRIVIAL(info) << "inbound queue overflow" << std::endl;
+                AsyncLog::info("inbound queue overflow");
             }
             simTime += std::chrono::milliseconds(1);
         }
 
         prevTime = simTime;
+        loopTimer.stop();
 
        
 
         // Sleep for a short duration to control the loop speed
         //Sleep(5);
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        Clock::sleepFor(std::chrono::milliseconds(5));
     }
 }
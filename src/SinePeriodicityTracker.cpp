@@ -0,0 +1,26 @@
+#include "SinePeriodicityTracker.h"
+
+
+SinePeriodicityTracker::SinePeriodicityTracker(float hysteresis, size_t historySize) : PeriodicityTracker(historySize),
+    _hysteresis(hysteresis),
+    _armed(false)
+{
+}
+
+bool SinePeriodicityTracker::isTransition(float prevAngle, float angle)
+{
+    if (angle > _hysteresis)
+        _armed = true;
+
+    if (_armed && prevAngle > 0 && angle <= 0)
+    {
+        _armed = false;
+        return true;
+    }
+    return false;
+}
+
+void SinePeriodicityTracker::resetHysteresis()
+{
+    _armed = false;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "PeriodicityTracker.h"
+
+/*
+* Detects the falling zero crossings of a sine like signal (oil pump).
+* After a crossing the signal has to rise above the hysteresis level before the next crossing is accepted.
+*/
+class SinePeriodicityTracker : public PeriodicityTracker
+{
+public:
+	SinePeriodicityTracker(float hysteresis = 1.0f, size_t historySize = 8);
+
+protected:
+	virtual bool isTransition(float prevAngle, float angle);
+	virtual void resetHysteresis();
+
+private:
+	float _hysteresis;
+	bool _armed;
+};
+
@@ -0,0 +1,90 @@
+#include "ThreadPool.h"
+#include "Tracer.h"
+#include <algorithm>
+
+
+ThreadPool::ThreadPool(size_t threads) : _shutdownRequested(false),
+    _generation(0),
+    _function(nullptr),
+    _count(0),
+    _nextItem(0),
+    _busyWorkers(0)
+{
+    for (size_t i = 1; i < std::max<size_t>(threads, 1); ++i)
+        _workers.emplace_back([this]() { workerThread(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::scoped_lock lock(_mutex);
+        _shutdownRequested = true;
+    }
+    _startCv.notify_all();
+    for (auto& worker : _workers)
+        worker.join();
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& f)
+{
+    if (count == 0)
+        return;
+
+    // nothing to share
+    if (_workers.empty() || count == 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            f(i);
+        return;
+    }
+
+    std::scoped_lock callerLock(_callerMutex);
+    {
+        std::scoped_lock lock(_mutex);
+        _function = &f;
+        _count = count;
+        _nextItem.store(0, std::memory_order_relaxed);
+        _busyWorkers = _workers.size();
+        _generation++;
+    }
+    _startCv.notify_all();
+
+    runItems();
+
+    // f must stay valid until every worker has left the loop
+    std::unique_lock lock(_mutex);
+    _doneCv.wait(lock, [this] { return _busyWorkers == 0; });
+    _function = nullptr;
+}
+
+void ThreadPool::runItems()
+{
+    for (size_t i = _nextItem.fetch_add(1, std::memory_order_relaxed); i < _count; i = _nextItem.fetch_add(1, std::memory_order_relaxed))
+        (*_function)(i);
+}
+
+void ThreadPool::workerThread()
+{
+    Tracer::setThreadName("pool worker");
+    size_t seenGeneration = 0;
+    while (true)
+    {
+        {
+            std::unique_lock lock(_mutex);
+            _startCv.wait(lock, [this, seenGeneration] { return _shutdownRequested || _generation != seenGeneration; });
+            if (_shutdownRequested)
+                return;
+            seenGeneration = _generation;
+        }
+
+        runItems();
+
+        bool last;
+        {
+            std::scoped_lock lock(_mutex);
+            last = --_busyWorkers == 0;
+        }
+        if (last)
+            _doneCv.notify_one();
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+* Small pool of persistent worker threads for data parallel loops, e.g. the offset search of TimeSeriesView::bestMatch.
+* parallelFor hands out the items one by one to the workers and the calling thread, and returns when all items are done.
+* Only one loop runs at a time, concurrent callers are serialized.
+*/
+class ThreadPool
+{
+public:
+	// threads includes the calling thread, so a pool of 1 runs everything on the caller
+	ThreadPool(size_t threads);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	size_t threads() const
+	{
+		return _workers.size() + 1;
+	}
+
+	// calls f(i) for every i in [0, count), in no particular order
+	void parallelFor(size_t count, const std::function<void(size_t)>& f);
+
+private:
+	void workerThread();
+	void runItems();
+
+private:
+	std::vector<std::thread> _workers;
+
+	std::mutex _callerMutex; // one loop at a time
+	std::mutex _mutex;
+	std::condition_variable _startCv;
+	std::condition_variable _doneCv;
+	bool _shutdownRequested;
+	size_t _generation; // incremented for every loop, wakes the workers
+
+	// current loop
+	const std::function<void(size_t)>* _function;
+	size_t _count;
+	std::atomic<size_t> _nextItem;
+	size_t _busyWorkers;
+};
+
@@ -4,34 +4,121 @@
 #include <chrono>
 #include <optional>
 #include <tuple>
+#include <memory_resource>
+#include "TimeSeriesView.h"
+#include "UniformTimeSeries.h"
 
+class CorrelationEngine;
+
+/*
+* Samples are stored column wise (structure of arrays): one contiguous column each for angles, timestamps and frame indices.
+* Hot loops should work on the columns directly, Sample tuples are only assembled on demand.
+* The read-only algorithms live in TimeSeriesView, a TimeSeries converts implicitly to a view on all of its samples.
+* The columns can be allocated from a memory resource, e.g. the CycleArena of the predictor. Copies always use the default resource.
+*/
 class TimeSeries
 {
 public:
-	typedef std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> Timestamp;
-	typedef std::tuple<float, Timestamp, int> Sample; // angle, time
-		
-	TimeSeries resample() const;
+	typedef TimeSeriesView::Timestamp Timestamp;
+	typedef TimeSeriesView::Sample Sample; // angle, time, frame index
+
+	TimeSeries() = default;
+	explicit TimeSeries(std::pmr::memory_resource* resource);
+	explicit TimeSeries(const TimeSeriesView& view, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	UniformTimeSeries resample() const;
+	void resampleIncremental(UniformTimeSeries& resampled) const;
 	void add(Sample sample);
-	std::vector<Sample>& getVector()
+	void add(float angle, Timestamp time, int frameIndex = 0);
+	void reserve(size_t size);
+	void clear();
+	void trimFront(const Timestamp& start);
+	void append(const TimeSeriesView& other);
+
+	size_t size() const
+	{
+		return _timestamps.size();
+	}
+	bool empty() const
+	{
+		return _timestamps.empty();
+	}
+	Sample operator[](size_t i) const
+	{
+		return { _angles[i], _timestamps[i], _frameIndices[i] };
+	}
+	Sample front() const
+	{
+		return (*this)[0];
+	}
+	Sample back() const
+	{
+		return (*this)[size() - 1];
+	}
+
+	// column access
+	float angle(size_t i) const
+	{
+		return _angles[i];
+	}
+	Timestamp time(size_t i) const
+	{
+		return _timestamps[i];
+	}
+	int frameIndex(size_t i) const
+	{
+		return _frameIndices[i];
+	}
+	const std::pmr::vector<float>& angles() const
+	{
+		return _angles;
+	}
+	std::pmr::vector<float>& angles()
+	{
+		return _angles;
+	}
+	const std::pmr::vector<Timestamp>& timestamps() const
+	{
+		return _timestamps;
+	}
+	const std::pmr::vector<int>& frameIndices() const
 	{
-		return _data;
+		return _frameIndices;
+	}
+
+	std::pmr::memory_resource* resource() const
+	{
+		return _angles.get_allocator().resource();
+	}
+
+	TimeSeriesView view() const
+	{
+		return TimeSeriesView(_angles.data(), _timestamps.data(), _frameIndices.data(), size());
+	}
+	operator TimeSeriesView() const
+	{
+		return view();
 	}
 
 	std::optional<std::tuple<std::chrono::milliseconds, TimeSeries::Timestamp>> calcPeriodicitySine() const;
 	std::chrono::milliseconds duration() const;
 	std::optional<size_t> findIndex(const Timestamp& timestamp) const;
-	TimeSeries crossFade(TimeSeries& other);
-	TimeSeries slice(const Timestamp& start, const Timestamp& end) const;
-	void mergeInto(TimeSeries& other);
-	float similarity( TimeSeries& other);
+	TimeSeries crossFade(const TimeSeriesView& other) const;
+	TimeSeriesView slice(const Timestamp& start, const Timestamp& end) const;
+	void mergeInto(const TimeSeriesView& other);
+	float similarity(const TimeSeriesView& other) const;
 	void shift(std::chrono::milliseconds offset);
 	bool checkConsistency();
 	void deduplicate();
-	std::chrono::milliseconds bestMatch(std::chrono::milliseconds windowExtension, TimeSeries& timeSeries);
+	std::chrono::milliseconds bestMatch(std::chrono::milliseconds windowExtension, const TimeSeriesView& timeSeries) const;
+	std::chrono::milliseconds bestMatch(std::chrono::milliseconds windowExtension, const TimeSeriesView& timeSeries, CorrelationEngine& engine) const;
+
+	static float interpolateAngle(float angle_lower, std::chrono::milliseconds duration_lower, float angle_upper, std::chrono::milliseconds duration_upper);
 
 private:
-	std::vector<Sample> _data;
+	std::pmr::vector<float> _angles;
+	std::pmr::vector<Timestamp> _timestamps;
+	std::pmr::vector<int> _frameIndices;
 
 };
 
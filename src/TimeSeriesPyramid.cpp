@@ -0,0 +1,86 @@
+#include "TimeSeriesPyramid.h"
+#include "SimdKernels.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <cassert>
+#include <tuple>
+
+
+TimeSeriesPyramid::TimeSeriesPyramid(const TimeSeriesView& series, std::initializer_list<size_t> factors, std::pmr::memory_resource* resource) : _resource(resource),
+    _factors(factors, resource),
+    _base(series),
+    _levels(resource)
+{
+    assert(!_factors.empty() && _factors[0] == 1);
+    _levels.reserve(_factors.size() - 1);
+    for (size_t l = 1; l < _factors.size(); ++l)
+    {
+        assert(_factors[l] % _factors[l - 1] == 0);
+        _levels.push_back(level(l - 1).decimate(_factors[l] / _factors[l - 1], _resource));
+    }
+}
+
+/*
+* The offsets of a level are the ones that align its samples with the pattern samples of the same level, i.e. a grid of factor ms.
+* On the way down each candidate is refined to the offsets within one coarse step around it on the finer grid.
+* Candidates of a level are at least one step apart, so they stand for different minima instead of the same one.
+* Only offsets that fully overlap the pattern are compared.
+*/
+std::chrono::milliseconds TimeSeriesPyramid::bestMatch(std::chrono::milliseconds windowExtension, const TimeSeriesPyramid& pattern, std::chrono::milliseconds patternShift, size_t candidates) const
+{
+    Tracer::Scope trace("pyramid bestMatch");
+    assert(pattern._factors == _factors);
+
+    if (windowExtension.count() <= 0 || pattern._base.empty() || _base.empty())
+        return std::chrono::milliseconds(0);
+
+    typedef std::tuple<float, std::chrono::milliseconds> Match; // sum of squared differences, offset
+    std::pmr::vector<Match> matches(_resource);
+    std::pmr::vector<std::chrono::milliseconds> picked(_resource);
+    const auto patternBegin = pattern._base.time(0) + patternShift;
+
+    // compares the pattern at all offsets of the level in [from, to]
+    auto searchRange = [&](size_t l, std::chrono::milliseconds from, std::chrono::milliseconds to) {
+        auto signal = level(l);
+        auto patternLevel = pattern.level(l);
+        size_t begin = signal.lowerBound(patternBegin + from);
+        for (size_t j = begin; j + patternLevel.size() <= signal.size() && signal.time(j) <= patternBegin + to; ++j)
+        {
+            float sumOfSquaredDifferences = SimdKernels::sumOfSquaredDifferences(signal.angles().data() + j, patternLevel.angles().data(), patternLevel.size());
+            matches.emplace_back(sumOfSquaredDifferences, std::chrono::duration_cast<std::chrono::milliseconds>(signal.time(j) - patternBegin));
+        }
+    };
+
+    // coarsest level over the whole window, plus one step of margin for the refinement
+    size_t l = levels() - 1;
+    auto margin = std::chrono::milliseconds(l > 0 ? _factors[l] : 0);
+    searchRange(l, -windowExtension - margin, windowExtension - std::chrono::milliseconds(1) + margin);
+
+    while (true)
+    {
+        // best first, ties towards the smaller offset
+        std::sort(matches.begin(), matches.end());
+        matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+        if (matches.empty())
+            return std::chrono::milliseconds(0);
+        if (l == 0)
+            return std::get<1>(matches.front());
+
+        auto step = std::chrono::milliseconds(_factors[l]);
+        picked.clear();
+        for (const auto& [sumOfSquaredDifferences, offset] : matches)
+        {
+            if (picked.size() >= std::max<size_t>(candidates, 1))
+                break;
+            if (std::all_of(picked.begin(), picked.end(), [offset, step](std::chrono::milliseconds other) { return std::chrono::abs(offset - other) > step; }))
+                picked.push_back(offset);
+        }
+
+        // refine on the next finer level, the final one is limited to the window itself
+        matches.clear();
+        l--;
+        auto finerMargin = std::chrono::milliseconds(l > 0 ? _factors[l] : 0);
+        for (auto offset : picked)
+            searchRange(l, std::max(offset - step, -windowExtension - finerMargin), std::min(offset + step, windowExtension - std::chrono::milliseconds(1) + finerMargin));
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <initializer_list>
+#include <memory_resource>
+#include <vector>
+#include "TimeSeries.h"
+
+/*
+* Multi resolution copy of an evenly spaced (resampled) series: level 0 is the series itself, each further level
+* is low pass filtered and decimated by its factor, e.g. 1, 4 and 16 ms.
+* Level 0 is a view, so the pyramid is invalidated by any modification of the series it was built from.
+* The coarser levels and the search state are allocated from the given memory resource.
+*/
+class TimeSeriesPyramid
+{
+public:
+	TimeSeriesPyramid() = default;
+	// factors: decimation of each level relative to the series, starting with 1, each a multiple of the previous one
+	TimeSeriesPyramid(const TimeSeriesView& series, std::initializer_list<size_t> factors = { 1, 4, 16 }, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	size_t levels() const
+	{
+		return _factors.size();
+	}
+	size_t factor(size_t level) const
+	{
+		return _factors[level];
+	}
+	TimeSeriesView level(size_t level) const
+	{
+		return level == 0 ? _base : _levels[level - 1].view();
+	}
+
+	/*
+	* Approximation of TimeSeriesView::bestMatch for evenly spaced series, searched coarse to fine:
+	* the coarsest level is searched over the whole window, each finer level only around the best candidates of the level above.
+	* It can miss the best offset if it is not among the candidates of a coarser level, and unlike the exhaustive search,
+	* which accepts slices up to 2 samples shorter than the pattern, only offsets where the pattern fully overlaps are compared.
+	* pattern has to be built with the same factors.
+	*/
+	std::chrono::milliseconds bestMatch(std::chrono::milliseconds windowExtension, const TimeSeriesPyramid& pattern, std::chrono::milliseconds patternShift, size_t candidates = 3) const;
+
+private:
+	std::pmr::memory_resource* _resource;
+	std::pmr::vector<size_t> _factors;
+	TimeSeriesView _base;
+	std::pmr::vector<TimeSeries> _levels;
+};
+
@@ -0,0 +1,456 @@
+#include "TimeSeriesView.h"
+#include "TimeSeries.h"
+#include "UniformTimeSeries.h"
+#include "CorrelationEngine.h"
+#include "SimdKernels.h"
+#include "ThreadPool.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+/*
+* Iterates over the time range spanned by the original samples.
+* For each millisecond, it interpolates the angle between the closest samples in the original data.
+* Both the output time and the input cursor only move forward, so the whole series is resampled in a single linear pass.
+* Returns the resampled time series.
+*/
+UniformTimeSeries TimeSeriesView::resample() const {
+    if (empty())
+        return UniformTimeSeries();
+
+    // Create a new time series with evenly spaced samples
+    UniformTimeSeries resampled_series;
+    resampled_series.reserve(duration().count());
+    resampleFrom(time(0) + std::chrono::milliseconds(1), resampled_series);
+
+    return resampled_series;
+}
+
+/*
+* Incremental variant of resample() for a series that only grows at the end and is trimmed at the front.
+* Only the samples appended since the last call are resampled and appended to resampled.
+* Resampled samples before the start of this series are dropped, so the result equals resample().
+* The latest sample may have been replaced by one with the same timestamp since the last call (RingTimeSeries::add),
+* so the interval leading up to it is resampled again.
+* If resampled does not overlap with this series it is rebuilt from scratch.
+*/
+void TimeSeriesView::resampleIncremental(UniformTimeSeries& resampled) const
+{
+    Tracer::Scope trace("resample");
+    if (empty())
+    {
+        resampled.clear();
+        return;
+    }
+
+    auto from = time(0) + std::chrono::milliseconds(1);
+    auto resampledEnd = resampled.empty() ? Timestamp() : resampled.time(resampled.size() - 1);
+    if (!resampled.empty() && resampledEnd >= time(0) && resampledEnd <= time(size() - 1))
+    {
+        resampled.trimFront(from);
+        if (!resampled.empty())
+        {
+            // resume after the sample before the last one resampled
+            auto resume = time(std::max<size_t>(lowerBound(resampledEnd), 1) - 1);
+            resampled.trimBack(resume);
+            from = std::max(from, resume + std::chrono::milliseconds(1));
+        }
+    }
+    else
+    {
+        resampled.clear();
+    }
+
+    resampleFrom(from, resampled);
+}
+
+/*
+* appends the resampled samples for [from, last sample] to resampled_series
+* The cursor pass only collects the neighbours of each interpolated sample, the angles are then computed in one vectorized pass.
+*/
+void TimeSeriesView::resampleFrom(Timestamp from, UniformTimeSeries& resampled_series) const
+{
+    if (empty() || from > time(size() - 1))
+        return;
+
+    auto last_time = time(size() - 1);
+
+    // neighbours of the interpolated samples, reused across calls
+    struct Neighbours
+    {
+        std::vector<float> lower, upper, distanceLower, distanceUpper, interpolated;
+        std::vector<size_t> positions;
+    };
+    thread_local Neighbours neighbours;
+    neighbours.lower.clear();
+    neighbours.upper.clear();
+    neighbours.distanceLower.clear();
+    neighbours.distanceUpper.clear();
+    neighbours.positions.clear();
+
+    // The upper cursor points to the first sample at or after the interpolated time
+    size_t upper = lowerBound(from);
+
+    for (auto interpolated_time = from; interpolated_time <= last_time; interpolated_time += std::chrono::milliseconds(1)) {
+
+        // Advance to the closest samples in the original data
+        while (time(upper) < interpolated_time)
+            upper++;
+
+        // If the time is before the first sample, skip
+        if (upper == 0)
+            continue;
+
+        // Interpolate between the closest samples
+        size_t lower = upper - 1;
+        auto time_lower = time(lower);
+        auto time_upper = time(upper);
+        auto duration_lower = std::chrono::duration_cast<std::chrono::milliseconds>(interpolated_time - time_lower);
+        auto duration_upper = std::chrono::duration_cast<std::chrono::milliseconds>(time_upper - interpolated_time);
+
+        // Check if duration_lower or duration_upper is zero to avoid division by zero
+        if (duration_lower.count() == 0) {
+            resampled_series.add(_angles[lower], time_lower);
+            continue;
+        }
+        if (duration_upper.count() == 0) {
+            resampled_series.add(_angles[upper], time_upper);
+            continue;
+        }
+
+        // Add a placeholder, the angle is filled in below
+        neighbours.positions.push_back(resampled_series.size());
+        neighbours.lower.push_back(_angles[lower]);
+        neighbours.upper.push_back(_angles[upper]);
+        neighbours.distanceLower.push_back((float)duration_lower.count());
+        neighbours.distanceUpper.push_back((float)duration_upper.count());
+        resampled_series.add(0.0f, interpolated_time);
+    }
+
+    size_t count = neighbours.positions.size();
+    neighbours.interpolated.resize(count);
+    SimdKernels::interpolateAngles(neighbours.lower.data(), neighbours.upper.data(), neighbours.distanceLower.data(), neighbours.distanceUpper.data(),
+        neighbours.interpolated.data(), count);
+
+    auto angles = resampled_series.angles();
+    for (size_t i = 0; i < count; ++i)
+        angles[neighbours.positions[i]] = neighbours.interpolated[i];
+}
+
+
+/**
+* We iterate over the samples in reverse order.
+* We search for the first encounter of a negative angle followed by a positive angle.
+* If found, we remember the timestamp of the positive angle.
+* Then, we search for the second encounter of a negative angle after the positive angle.
+* If found, we calculate the difference in time between the two encounters and return it.
+* If any step fails, we return an empty optional.
+*/
+std::optional<std::tuple<std::chrono::milliseconds, TimeSeriesView::Timestamp>> TimeSeriesView::calcPeriodicitySine() const {
+    Timestamp first_transition;
+    bool found_first_transition = false;
+    Timestamp second_transition;
+    bool found_second_transition = false;
+
+    if (size() < 2)
+        return std::nullopt;
+
+    for (size_t i = size() - 1; i-- > 0;) {
+        float angle = _angles[i];
+        float prev_angle = _angles[i + 1];
+
+        if (!found_first_transition && prev_angle <= 0 && angle > 0) {
+            found_first_transition = true;
+            first_transition = time(i);
+        }
+        else if (found_first_transition && prev_angle <= 0 && angle > 0) {
+            found_second_transition = true;
+            second_transition = time(i);
+            break; // No need to iterate further
+        }
+    }
+
+    if (!found_first_transition || !found_second_transition) {
+        return std::nullopt; // Either transition not found
+    }
+
+    // Calculate the time difference between the two transitions
+    std::tuple<std::chrono::milliseconds, Timestamp> ret = { std::chrono::duration_cast<std::chrono::milliseconds>(first_transition - second_transition), first_transition };
+    return ret;
+}
+
+
+std::chrono::milliseconds TimeSeriesView::duration() const {
+    if (empty()) {
+        return std::chrono::milliseconds(0);
+    }
+    else {
+        auto first_time = time(0);
+        auto last_time = time(size() - 1);
+        return std::chrono::duration_cast<std::chrono::milliseconds>(last_time - first_time);
+    }
+}
+
+size_t TimeSeriesView::lowerBound(const Timestamp& timestamp) const
+{
+    if (_step.count() <= 0)
+        return std::distance(_timestamps.begin(), std::lower_bound(_timestamps.begin(), _timestamps.end(), timestamp));
+
+    if (empty() || timestamp <= _start)
+        return 0;
+    if (timestamp > time(size() - 1))
+        return size();
+    return (size_t)((timestamp - _start + _step - std::chrono::milliseconds(1)) / _step);
+}
+
+size_t TimeSeriesView::upperBound(const Timestamp& timestamp) const
+{
+    if (_step.count() <= 0)
+        return std::distance(_timestamps.begin(), std::upper_bound(_timestamps.begin(), _timestamps.end(), timestamp));
+
+    if (empty() || timestamp < _start)
+        return 0;
+    if (timestamp >= time(size() - 1))
+        return size();
+    return (size_t)((timestamp - _start) / _step) + 1;
+}
+
+std::optional<size_t> TimeSeriesView::findIndex(const Timestamp& timestamp) const {
+    size_t index = lowerBound(timestamp);
+
+    if (index < size()) {
+            return index;
+    }
+    else {
+        return std::nullopt;
+    }
+}
+
+
+/* cross fade other ts at the end of this ts from the point they overlap*/
+TimeSeries TimeSeriesView::crossFade(const TimeSeriesView& other) const
+{
+    TimeSeries result;
+
+    if (other.size() < 2)
+        return TimeSeries(*this);
+
+    // Find the index where the other TimeSeries starts in this TimeSeries
+    auto index = findIndex(other.time(0));
+    if (!index) {
+        return TimeSeries(*this);
+    }
+
+    // Calculate the number of elements to crossfade
+    size_t num_elements_to_crossfade = std::min(size() - *index, other.size());
+
+    //copy in the first part of the TS, the overlap is blended in place
+    result.reserve(*index + other.size());
+    result.append(subView(0, *index + num_elements_to_crossfade));
+    SimdKernels::crossFade(_angles.data() + *index, other._angles.data(), result.angles().data() + *index, num_elements_to_crossfade);
+
+    // Directly copy the remaining elements from other TimeSeries to result
+    auto otherCpyfrom = other.findIndex(time(size() - 1));
+
+    if (otherCpyfrom)
+    {
+        result.append(other.subView(*otherCpyfrom + 1, other.size() - *otherCpyfrom - 1));
+    }
+
+    return result;
+}
+
+
+/*
+* Keeps every factor-th sample, low pass filtered with a triangular window of 2 * factor - 1 samples.
+* The window has its zeros at multiples of the new sampling rate, which suppresses most of the aliasing.
+* The filter is linear in the angle, roll overs (wheel) are not unwrapped.
+*/
+TimeSeries TimeSeriesView::decimate(size_t factor, std::pmr::memory_resource* resource) const
+{
+    if (factor <= 1)
+        return TimeSeries(*this, resource);
+
+    TimeSeries decimated(resource);
+    decimated.reserve(size() / factor + 1);
+    const ptrdiff_t halfWidth = (ptrdiff_t)factor - 1;
+    for (size_t center = 0; center < size(); center += factor)
+    {
+        // at the ends, only the taps inside the series are used
+        ptrdiff_t first = std::max<ptrdiff_t>((ptrdiff_t)center - halfWidth, 0);
+        ptrdiff_t last = std::min<ptrdiff_t>((ptrdiff_t)center + halfWidth, (ptrdiff_t)size() - 1);
+        float sum = 0.0f;
+        float weights = 0.0f;
+        for (ptrdiff_t i = first; i <= last; ++i)
+        {
+            float weight = (float)((ptrdiff_t)factor - std::abs(i - (ptrdiff_t)center));
+            sum += _angles[i] * weight;
+            weights += weight;
+        }
+        decimated.add(sum / weights, time(center), frameIndex(center));
+    }
+    return decimated;
+}
+
+
+TimeSeriesView TimeSeriesView::slice(const Timestamp& start, const Timestamp& end) const {
+
+        // Find the start and end of the slice
+        size_t begin = lowerBound(start);
+        size_t finish = upperBound(end);
+        if (begin >= finish)
+            return TimeSeriesView();
+
+        return subView(begin, finish - begin);
+}
+
+
+float TimeSeriesView::similarity(const TimeSeriesView& other) const
+{
+    // Ensure both time series have the same length
+    size_t min_length = std::min(size(), other.size());
+
+    // Compute the squared differences and sum them up
+    float sum_of_squared_differences = SimdKernels::sumOfSquaredDifferences(_angles.data(), other._angles.data(), min_length);
+
+    // Calculate the Euclidean distance (L2 norm)
+    float euclidean_distance = std::sqrt(sum_of_squared_differences);
+
+    // Return the similarity (inverse of distance)
+    return 1.0f / (1.0f + euclidean_distance);
+}
+
+
+/*
+* Finds the offset within [-windowExtension, windowExtension) by which timeSeries, already moved by timeSeriesShift,
+* has to be shifted to match this series best.
+* For each offset this series is sliced to the time range of the shifted timeSeries and compared sample by sample.
+* The sum of squared differences is expanded into sum(a^2) + sum(b^2) - 2 sum(a*b): the squares come from prefix sums
+* and the cross term for all offsets of a block from a single correlation pass, so the cost hardly depends on the window size.
+* The offsets are searched in blocks of a fixed size, in parallel if a pool is given. The blocks do not depend on the
+* number of threads, so the result is the same with and without a pool. Ties are resolved towards the smaller offset.
+*/
+std::chrono::milliseconds TimeSeriesView::bestMatch(std::chrono::milliseconds windowExtension, const TimeSeriesView& timeSeries, std::chrono::milliseconds timeSeriesShift, CorrelationEngine& engine, ThreadPool* pool) const
+{
+    Tracer::Scope trace("bestMatch");
+    if (timeSeries.empty() || windowExtension.count() <= 0)
+        return std::chrono::milliseconds(0);
+
+    const size_t n = size();
+    const size_t patternSize = timeSeries.size();
+    const float* a = _angles.data();
+    const float* b = timeSeries._angles.data();
+    const auto patternBegin = timeSeries.time(0) + timeSeriesShift;
+    const auto patternEnd = timeSeries.time(timeSeries.size() - 1) + timeSeriesShift;
+
+    auto firstSliceStart = [this, patternBegin](std::chrono::milliseconds offset) {
+        return lowerBound(patternBegin + offset);
+    };
+
+    // range of slice starts over all offsets
+    size_t firstStart = firstSliceStart(-windowExtension);
+    size_t lastStart = firstSliceStart(windowExtension - std::chrono::milliseconds(1));
+    size_t signalSize = std::min(n - firstStart, lastStart - firstStart + patternSize);
+
+    // scratch buffers of the calling thread, kept between calls like the ones of the correlation engine.
+    // Taken by reference, so the blocks running on pool threads use them as well
+    struct Scratch
+    {
+        std::vector<double> signalSquares, patternSquares;
+        std::vector<std::tuple<float, std::chrono::milliseconds>> blockMatches;
+    };
+    thread_local Scratch scratch;
+    auto& signalSquares = scratch.signalSquares;
+    auto& patternSquares = scratch.patternSquares;
+    auto& blockMatches = scratch.blockMatches;
+
+    signalSquares.assign(signalSize + 1, 0.0);
+    for (size_t i = 0; i < signalSize; ++i)
+        signalSquares[i + 1] = signalSquares[i] + (double)a[firstStart + i] * (double)a[firstStart + i];
+
+    patternSquares.assign(patternSize + 1, 0.0);
+    for (size_t i = 0; i < patternSize; ++i)
+        patternSquares[i + 1] = patternSquares[i] + (double)b[i] * (double)b[i];
+
+    // best similarity and offset per block
+    const auto blockSize = std::chrono::milliseconds(1024);
+    size_t blocks = (size_t)((2 * windowExtension + blockSize - std::chrono::milliseconds(1)) / blockSize);
+    blockMatches.assign(blocks, { 0.0f, std::chrono::milliseconds(0) });
+
+    auto searchBlock = [&](size_t block, CorrelationEngine& blockEngine) {
+        auto blockBegin = -windowExtension + (std::chrono::milliseconds::rep)block * blockSize;
+        auto blockEnd = std::min(blockBegin + blockSize, windowExtension);
+
+        size_t blockStart = firstSliceStart(blockBegin);
+        size_t blockLags = firstSliceStart(blockEnd - std::chrono::milliseconds(1)) - blockStart + 1;
+
+        thread_local std::vector<double> dotProducts;
+        blockEngine.slidingDotProducts(a + blockStart, n - blockStart, b, patternSize, blockLags, dotProducts);
+
+        float bestSimilarity = 0.0f;
+        std::chrono::milliseconds bestOffset = std::chrono::milliseconds(0);
+
+        // slice bounds, both only move forward with the offset
+        size_t sliceBegin = blockStart;
+        size_t sliceEnd = blockStart;
+        for (auto i = blockBegin; i < blockEnd; i += std::chrono::milliseconds(1)) {
+            while (sliceBegin < n && time(sliceBegin) < patternBegin + i)
+                sliceBegin++;
+            sliceEnd = std::max(sliceEnd, sliceBegin);
+            while (sliceEnd < n && time(sliceEnd) <= patternEnd + i)
+                sliceEnd++;
+
+            // Check if the size difference is within a threshold
+            size_t sliceSize = sliceEnd - sliceBegin;
+            if (std::abs(static_cast<int>(sliceSize) - static_cast<int>(patternSize)) > 2)
+                continue;
+
+            // sum of squared differences over the common length
+            size_t length = std::min(sliceSize, patternSize);
+            size_t offset = sliceBegin - firstStart;
+            double crossTerm = dotProducts[sliceBegin - blockStart];
+            for (size_t k = length; k < patternSize && sliceBegin + k < n; ++k)
+                crossTerm -= (double)a[sliceBegin + k] * (double)b[k];
+            double sumOfSquaredDifferences = signalSquares[offset + length] - signalSquares[offset] + patternSquares[length] - 2.0 * crossTerm;
+
+            // Calculate similarity
+            float curSimilarity = 1.0f / (1.0f + std::sqrt(std::max(0.0f, (float)sumOfSquaredDifferences)));
+
+            // Update best match if similarity is higher
+            if (curSimilarity > bestSimilarity) {
+                bestSimilarity = curSimilarity;
+                bestOffset = i;
+            }
+        }
+
+        blockMatches[block] = { bestSimilarity, bestOffset };
+    };
+
+    if (pool && blocks > 1)
+    {
+        // every thread needs its own scratch buffers
+        pool->parallelFor(blocks, [&searchBlock](size_t block) {
+            thread_local CorrelationEngine blockEngine;
+            searchBlock(block, blockEngine);
+        });
+    }
+    else
+    {
+        for (size_t block = 0; block < blocks; ++block)
+            searchBlock(block, engine);
+    }
+
+    // merge in offset order, so ties still go to the smaller offset
+    float bestSimilarity = 0.0f;
+    std::chrono::milliseconds bestOffset = std::chrono::milliseconds(0);
+    for (const auto& [similarity, offset] : blockMatches) {
+        if (similarity > bestSimilarity) {
+            bestSimilarity = similarity;
+            bestOffset = offset;
+        }
+    }
+
+    return bestOffset;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <span>
+#include <chrono>
+#include <optional>
+#include <tuple>
+#include <memory_resource>
+
+class TimeSeries;
+class UniformTimeSeries;
+class CorrelationEngine;
+class ThreadPool;
+
+/*
+* Non-owning, read-only view on the columns of a TimeSeries or RingTimeSeries.
+* Slicing a view yields another view, data is only copied by the operations that produce modified samples.
+* A view is invalidated by any modification of the series it was taken from.
+* Views on evenly spaced samples (UniformTimeSeries) have no timestamp and frame index columns: the timestamps are computed
+* from the start and the step, and looked up arithmetically instead of by binary search.
+*/
+class TimeSeriesView
+{
+public:
+	typedef std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> Timestamp;
+	typedef std::tuple<float, Timestamp, int> Sample; // angle, time, frame index
+
+	TimeSeriesView() = default;
+	TimeSeriesView(const float* angles, const Timestamp* timestamps, const int* frameIndices, size_t size) :
+		_angles(angles, size),
+		_timestamps(timestamps, size),
+		_frameIndices(frameIndices, size)
+	{
+	}
+	// evenly spaced samples, sample i is at start + i * step
+	TimeSeriesView(const float* angles, size_t size, Timestamp start, std::chrono::milliseconds step) :
+		_angles(angles, size),
+		_start(start),
+		_step(step)
+	{
+	}
+
+	size_t size() const
+	{
+		return _angles.size();
+	}
+	bool empty() const
+	{
+		return _angles.empty();
+	}
+	Sample operator[](size_t i) const
+	{
+		return { _angles[i], time(i), frameIndex(i) };
+	}
+	Sample front() const
+	{
+		return (*this)[0];
+	}
+	Sample back() const
+	{
+		return (*this)[size() - 1];
+	}
+	float angle(size_t i) const
+	{
+		return _angles[i];
+	}
+	Timestamp time(size_t i) const
+	{
+		return _step.count() > 0 ? _start + (std::chrono::milliseconds::rep)i * _step : _timestamps[i];
+	}
+	int frameIndex(size_t i) const
+	{
+		return _frameIndices.empty() ? 0 : _frameIndices[i];
+	}
+	std::span<const float> angles() const
+	{
+		return _angles;
+	}
+	std::chrono::milliseconds step() const
+	{
+		return _step;
+	}
+	TimeSeriesView subView(size_t begin, size_t count) const
+	{
+		if (_step.count() > 0)
+			return TimeSeriesView(_angles.data() + begin, count, time(begin), _step);
+		return TimeSeriesView(_angles.data() + begin, _timestamps.data() + begin, _frameIndices.data() + begin, count);
+	}
+
+	// index of the first sample at or after / after timestamp, size() if there is none
+	size_t lowerBound(const Timestamp& timestamp) const;
+	size_t upperBound(const Timestamp& timestamp) const;
+
+	std::optional<size_t> findIndex(const Timestamp& timestamp) const;
+	TimeSeriesView slice(const Timestamp& start, const Timestamp& end) const;
+	std::chrono::milliseconds duration() const;
+	float similarity(const TimeSeriesView& other) const;
+	std::optional<std::tuple<std::chrono::milliseconds, Timestamp>> calcPeriodicitySine() const;
+	std::chrono::milliseconds bestMatch(std::chrono::milliseconds windowExtension, const TimeSeriesView& timeSeries, std::chrono::milliseconds timeSeriesShift, CorrelationEngine& engine, ThreadPool* pool = nullptr) const;
+
+	UniformTimeSeries resample() const;
+	void resampleIncremental(UniformTimeSeries& resampled) const;
+	TimeSeries crossFade(const TimeSeriesView& other) const;
+	TimeSeries decimate(size_t factor, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+private:
+	void resampleFrom(Timestamp from, UniformTimeSeries& resampled_series) const;
+
+private:
+	std::span<const float> _angles;
+	std::span<const Timestamp> _timestamps; // empty if evenly spaced
+	std::span<const int> _frameIndices; // empty if evenly spaced
+	Timestamp _start;
+	std::chrono::milliseconds _step = std::chrono::milliseconds(0); // 0 if the spacing is irregular
+};
+
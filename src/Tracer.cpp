@@ -0,0 +1,127 @@
+#include "Tracer.h"
+#include <boost/log/trivial.hpp>
+#include <fstream>
+#include <iomanip>
+
+
+std::atomic<bool> Tracer::_enabled(false);
+std::string Tracer::_fileName;
+std::chrono::steady_clock::time_point Tracer::_start;
+std::mutex Tracer::_mutex;
+std::vector<std::unique_ptr<Tracer::ThreadBuffer>> Tracer::_buffers;
+
+
+Tracer::Scope::Scope(const char* name) : _name(enabled() ? name : nullptr),
+    _begin(_name ? now() : 0)
+{
+}
+
+Tracer::Scope::~Scope()
+{
+    if (_name)
+        record(_name, _begin, now() - _begin);
+}
+
+void Tracer::start(const std::string& fileName)
+{
+    _fileName = fileName;
+    _start = std::chrono::steady_clock::now();
+    _enabled.store(true, std::memory_order_release);
+}
+
+void Tracer::stop()
+{
+    if (!_enabled.exchange(false))
+        return;
+    write();
+}
+
+void Tracer::instant(const char* name)
+{
+    if (enabled())
+        record(name, now(), -1);
+}
+
+void Tracer::setThreadName(const char* name)
+{
+    if (enabled())
+        threadBuffer()->name.store(name, std::memory_order_relaxed);
+}
+
+int64_t Tracer::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count();
+}
+
+/* the buffer of the calling thread, created on its first event */
+Tracer::ThreadBuffer* Tracer::threadBuffer()
+{
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer)
+    {
+        auto created = std::make_unique<ThreadBuffer>();
+        created->events.resize(eventsPerThread);
+        created->size.store(0, std::memory_order_relaxed);
+        created->dropped.store(0, std::memory_order_relaxed);
+        created->name.store(nullptr, std::memory_order_relaxed);
+
+        std::scoped_lock lock(_mutex);
+        created->id = (uint32_t)_buffers.size() + 1;
+        buffer = created.get();
+        _buffers.push_back(std::move(created));
+    }
+    return buffer;
+}
+
+void Tracer::record(const char* name, int64_t begin, int64_t duration)
+{
+    ThreadBuffer* buffer = threadBuffer();
+    size_t index = buffer->size.load(std::memory_order_relaxed);
+    if (index >= buffer->events.size())
+    {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[index] = { name, begin, duration };
+    // publishes the event to the writer
+    buffer->size.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::write()
+{
+    std::ofstream out(_fileName);
+    if (!out.is_open())
+    {
+        BOOST_LOG_TRIVIAL(info) << "could not write trace file " << _fileName << std::endl;
+        return;
+    }
+
+    std::scoped_lock lock(_mutex);
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"oil_pump\"}}";
+
+    uint64_t dropped = 0;
+    for (const auto& buffer : _buffers)
+    {
+        const char* name = buffer->name.load(std::memory_order_relaxed);
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+            << ",\"args\":{\"name\":\"" << (name ? name : "thread") << "\"}}";
+
+        size_t size = buffer->size.load(std::memory_order_acquire);
+        for (size_t i = 0; i < size; i++)
+        {
+            const Event& event = buffer->events[i];
+            out << ",\n{\"name\":\"" << event.name << "\",\"pid\":1,\"tid\":" << buffer->id << ",\"ts\":" << (double)event.begin / 1000.0;
+            if (event.duration < 0)
+                out << ",\"ph\":\"i\",\"s\":\"t\"}";
+            else
+                out << ",\"ph\":\"X\",\"dur\":" << (double)event.duration / 1000.0 << "}";
+        }
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    out << "\n]}\n";
+
+    if (dropped > 0)
+        BOOST_LOG_TRIVIAL(info) << "trace buffers full, dropped events: " << dropped << std::endl;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+* Optional timeline of the pipeline threads, written as Chrome trace JSON (chrome://tracing, ui.perfetto.dev) by stop().
+* Every thread records into its own fixed size buffer, recording takes no lock and never allocates after the first event.
+* When a buffer is full, further events of that thread are dropped and counted.
+* Event and thread names have to be string literals, only the pointers are stored.
+*/
+class Tracer
+{
+public:
+	// complete event from construction to destruction
+	class Scope
+	{
+	public:
+		Scope(const char* name);
+		~Scope();
+
+	private:
+		const char* _name;
+		int64_t _begin;
+	};
+
+	static bool enabled()
+	{
+		return _enabled.load(std::memory_order_relaxed);
+	}
+
+	static void start(const std::string& fileName);
+	// writes the trace, all traced threads should have finished
+	static void stop();
+
+	static void instant(const char* name);
+	static void setThreadName(const char* name);
+
+private:
+	struct Event
+	{
+		const char* name;
+		int64_t begin; // ns since start
+		int64_t duration; // ns, negative for instant events
+	};
+
+	struct ThreadBuffer
+	{
+		std::vector<Event> events;
+		std::atomic<size_t> size;
+		std::atomic<uint64_t> dropped;
+		std::atomic<const char*> name;
+		uint32_t id;
+	};
+
+	static int64_t now();
+	static ThreadBuffer* threadBuffer();
+	static void record(const char* name, int64_t begin, int64_t duration);
+	static void write();
+
+private:
+	static constexpr size_t eventsPerThread = 1 << 18;
+
+	static std::atomic<bool> _enabled;
+	static std::string _fileName;
+	static std::chrono::steady_clock::time_point _start;
+	static std::mutex _mutex; // registration of thread buffers only
+	static std::vector<std::unique_ptr<ThreadBuffer>> _buffers;
+};
+
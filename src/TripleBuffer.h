@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/*
+* Wait-free single producer / single consumer hand-off of the latest value.
+* The producer fills back() and publishes it, the consumer reads the newest published value in place.
+* Neither side ever blocks or copies: the three slots are rotated by exchanging indices, so the producer
+* always has a slot the consumer is not reading and the consumer keeps its slot until it asks for a newer one.
+*/
+template <typename T>
+class TripleBuffer
+{
+public:
+	// producer side: the slot to fill, it still contains the value published two rounds ago
+	T& back()
+	{
+		return _slots[_back];
+	}
+	void publish()
+	{
+		_back = _middle.exchange(_back | FreshBit, std::memory_order_acq_rel) & IndexMask;
+	}
+
+	// consumer side: the newest published value, it stays valid and unchanged until the next call of read()
+	const T& read()
+	{
+		if (_middle.load(std::memory_order_relaxed) & FreshBit)
+			_front = _middle.exchange(_front, std::memory_order_acq_rel) & IndexMask;
+		return _slots[_front];
+	}
+
+private:
+	static constexpr uint8_t IndexMask = 3;
+	static constexpr uint8_t FreshBit = 4;
+
+	std::array<T, 3> _slots;
+	alignas(64) uint8_t _back = 0;
+	alignas(64) std::atomic<uint8_t> _middle = 1;
+	alignas(64) uint8_t _front = 2;
+};
+
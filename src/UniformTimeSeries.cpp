@@ -0,0 +1,65 @@
+#include "UniformTimeSeries.h"
+#include <algorithm>
+#include <cassert>
+
+
+UniformTimeSeries::UniformTimeSeries(std::chrono::milliseconds step, std::pmr::memory_resource* resource) : _step(std::max(step, std::chrono::milliseconds(1))),
+    _angles(resource),
+    _offset(0)
+{
+}
+
+void UniformTimeSeries::add(float angle, Timestamp time)
+{
+    if (empty())
+        _start = time;
+    assert(time == this->time(size()));
+
+    _angles.push_back(angle);
+}
+
+void UniformTimeSeries::reserve(size_t size)
+{
+    _angles.reserve(_offset + size);
+}
+
+void UniformTimeSeries::clear()
+{
+    _angles.clear();
+    _offset = 0;
+}
+
+/* removes all samples older than start, the memory is only moved once the trimmed part is larger than the rest (amortized O(1) per sample) */
+void UniformTimeSeries::trimFront(const Timestamp& start)
+{
+    size_t count = view().lowerBound(start);
+    _offset += count;
+    _start += (std::chrono::milliseconds::rep)count * _step;
+
+    if (_offset > size())
+    {
+        _angles.erase(_angles.begin(), _angles.begin() + _offset);
+        _offset = 0;
+    }
+}
+
+/* removes all samples newer than end */
+void UniformTimeSeries::trimBack(const Timestamp& end)
+{
+    _angles.resize(_offset + view().upperBound(end));
+}
+
+std::optional<size_t> UniformTimeSeries::findIndex(const Timestamp& timestamp) const
+{
+    return view().findIndex(timestamp);
+}
+
+TimeSeriesView UniformTimeSeries::slice(const Timestamp& start, const Timestamp& end) const
+{
+    return view().slice(start, end);
+}
+
+std::chrono::milliseconds UniformTimeSeries::duration() const
+{
+    return empty() ? std::chrono::milliseconds(0) : (std::chrono::milliseconds::rep)(size() - 1) * _step;
+}
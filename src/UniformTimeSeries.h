@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <optional>
+#include <span>
+#include <memory_resource>
+#include "TimeSeriesView.h"
+
+/*
+* Time series with evenly spaced samples, e.g. the result of TimeSeries::resample(): sample i is at start() + i * step().
+* Only the angles are stored, timestamps are computed and positions found arithmetically, so findIndex and slice are O(1).
+* There are no frame indices, they read as 0.
+* Trimming the front only moves an offset, the dropped angles are compacted once they outnumber the live ones.
+*/
+class UniformTimeSeries
+{
+public:
+	typedef TimeSeriesView::Timestamp Timestamp;
+	typedef TimeSeriesView::Sample Sample;
+
+	explicit UniformTimeSeries(std::chrono::milliseconds step = std::chrono::milliseconds(1), std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	// time has to be one step after the last sample, the first sample sets the start
+	void add(float angle, Timestamp time);
+	void reserve(size_t size);
+	void clear();
+	void trimFront(const Timestamp& start);
+	void trimBack(const Timestamp& end);
+
+	size_t size() const
+	{
+		return _angles.size() - _offset;
+	}
+	bool empty() const
+	{
+		return size() == 0;
+	}
+	std::chrono::milliseconds step() const
+	{
+		return _step;
+	}
+	Timestamp start() const
+	{
+		return _start;
+	}
+	Sample operator[](size_t i) const
+	{
+		return { angle(i), time(i), 0 };
+	}
+	float angle(size_t i) const
+	{
+		return _angles[_offset + i];
+	}
+	Timestamp time(size_t i) const
+	{
+		return _start + (std::chrono::milliseconds::rep)i * _step;
+	}
+	std::span<const float> angles() const
+	{
+		return { _angles.data() + _offset, size() };
+	}
+	std::span<float> angles()
+	{
+		return { _angles.data() + _offset, size() };
+	}
+
+	TimeSeriesView view() const
+	{
+		return TimeSeriesView(_angles.data() + _offset, size(), _start, _step);
+	}
+	operator TimeSeriesView() const
+	{
+		return view();
+	}
+
+	// index of the first sample at or after timestamp
+	std::optional<size_t> findIndex(const Timestamp& timestamp) const;
+	TimeSeriesView slice(const Timestamp& start, const Timestamp& end) const;
+	std::chrono::milliseconds duration() const;
+
+private:
+	std::chrono::milliseconds _step;
+	Timestamp _start; // time of the first live sample
+	std::pmr::vector<float> _angles;
+	size_t _offset; // trimmed angles at the front of _angles
+};
+
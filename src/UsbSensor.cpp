@@ -1,4 +1,8 @@
 #include "UsbSensor.h"
+#include "AsyncLog.h"
+#include "Clock.h"
+#include "Instrumentation.h"
+#include "Tracer.h"
 
 #include <boost/log/trivial.hpp>
 
@@ -86,6 +90,7 @@ void UsbSensor::shutdown()
 
 void UsbSensor::readThread(Sensor::Queue& queue)
 {
+    Tracer::setThreadName("sensor");
     initialize_usb_device();
 
     const int AS5600_SCL = 19;
@@ -111,6 +116,7 @@ void UsbSensor::readThread(Sensor::Queue& queue)
     int i = 0;
     while (!_shutdownRequested)
     {
+        Instrumentation::LoopTimer loopTimer(Instrumentation::sensor);
         i++;
         perform_control_transfer((LIBUSB_REQUEST_TYPE_CLASS & ~LIBUSB_ENDPOINT_DIR_MASK) | LIBUSB_ENDPOINT_OUT,
             CMD_I2C_IO + CMD_I2C_IO_BEGIN, 0, AS5600_ADDRESS, &buf[0], 1);
@@ -121,9 +127,9 @@ void UsbSensor::readThread(Sensor::Queue& queue)
         float angle = static_cast<float>(((buf[1] << 8) | buf[2])) / 4096.0f * 360.0f - _magnetOffset;
       
      
-        if (!queue.push({ angle, std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()), 0 }))
+        if (!queue.push({ angle, Clock::now(), 0 }))
         {
-            BOOST_LOG_TRIVIAL(info) << "inbound queue overflow" << std::endl;
+            AsyncLog::info("inbound queue overflow");
         }
 
     }
@@ -3,6 +3,7 @@
 #include "Sensor.h"
 #include <thread>
 #include "AbstractMovementPredictor.h"
+#include "WheelPeriodicityTracker.h"
 
 class WheelMovementPredictor : public AbstractMovementPredictor
 {
@@ -11,7 +12,11 @@ public:
 
 
 protected:
-	virtual std::optional<std::tuple<std::chrono::milliseconds, TimeSeries::Timestamp>> calcPeriodicity(TimeSeries& ts);
+	virtual std::optional<std::tuple<std::chrono::milliseconds, TimeSeries::Timestamp>> calcPeriodicity(const TimeSeriesView& ts);
+	virtual SampleQueue::WakeupEvent wakeupEvent() const;
+
+private:
+	WheelPeriodicityTracker _periodicityTracker;
 };
 
 
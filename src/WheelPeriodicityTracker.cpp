@@ -0,0 +1,28 @@
+#include "WheelPeriodicityTracker.h"
+
+
+WheelPeriodicityTracker::WheelPeriodicityTracker(size_t historySize) : PeriodicityTracker(historySize),
+    _armed(false)
+{
+}
+
+bool WheelPeriodicityTracker::isTransition(float prevAngle, float angle)
+{
+    const float UPPER_THRESHOLD = 359.0f;
+    const float LOWER_THRESHOLD = 1.0f;
+
+    if (angle > 90.0f && angle < 270.0f)
+        _armed = true;
+
+    if (_armed && prevAngle > UPPER_THRESHOLD && angle < LOWER_THRESHOLD)
+    {
+        _armed = false;
+        return true;
+    }
+    return false;
+}
+
+void WheelPeriodicityTracker::resetHysteresis()
+{
+    _armed = false;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "PeriodicityTracker.h"
+
+/*
+* Detects the wrap around from 360 to 0 degrees of a rotating wheel.
+* After a wrap around the wheel has to pass the opposite half of the turn before the next one is accepted,
+* so jitter around 0 degrees is not counted as a full turn.
+*/
+class WheelPeriodicityTracker : public PeriodicityTracker
+{
+public:
+	WheelPeriodicityTracker(size_t historySize = 8);
+
+protected:
+	virtual bool isTransition(float prevAngle, float angle);
+	virtual void resetHysteresis();
+
+private:
+	bool _armed;
+};
+
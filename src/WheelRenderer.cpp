@@ -1,31 +1,28 @@
 #include "WheelRenderer.h"
 
 WheelRenderer::WheelRenderer(const std::string& fileName, bool fullscreen, float scale, Sensor::Queue& inbound) : _inbound(inbound),
-OpenGLRenderer(fileName, fullscreen, scale)
+OpenGLRenderer(fileName, fullscreen, scale),
+_latestAngle(0.0f)
 {
 
 }
 
 
 
-float WheelRenderer::findAngleToRender(std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> ts, TimeSeries& localTS)
+float WheelRenderer::findAngleToRender(std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> ts, const PredictionSnapshot& snapshot)
 {
-    // copy from queue into local time series
-    _inbound.consume_all([&localTS](const TimeSeries::Sample& sample)
+    // the wheel is rendered from the raw sensor data, only the latest angle is needed
+    _inbound.consume_all([this](const TimeSeries::Sample& sample)
         {
-            localTS.add(sample);
+            _latestAngle = std::get<0>(sample);
         });
-    float angle = 0.0;
 
-    if (!localTS.getVector().empty())
-        angle = std::get<0>(localTS.getVector().back());
-
-    return angle;
+    return _latestAngle;
 }
 
 
 int WheelRenderer::findFrameToRender(std::optional<int> prevFrame, float angle,
-    std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> refNow, TimeSeries& localTS)
+    std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> refNow, const PredictionSnapshot& snapshot)
 {
     if (prevFrame)
     {
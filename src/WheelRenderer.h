@@ -11,9 +11,10 @@ public:
 
 public:
     int findFrameToRender(std::optional<int> prevFrame, float angle,
-        std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> refNow, TimeSeries& localTS);
-    float findAngleToRender(std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> ts, TimeSeries& localTS);
+        std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> refNow, const PredictionSnapshot& snapshot);
+    float findAngleToRender(std::chrono::time_point<std::chrono::steady_clock, std::chrono::milliseconds> ts, const PredictionSnapshot& snapshot);
 
     Sensor::Queue& _inbound;
+    float _latestAngle;
 };
 
@@ -1,6 +1,9 @@
 #include "WheelSimulationSensor.h"
+#include "AsyncLog.h"
+#include "Clock.h"
+#include "Instrumentation.h"
+#include "Tracer.h"
 
-#include <boost/log/trivial.hpp>
 #include <numbers>
 //#include "windows.h"
 #include <cmath>
@@ -12,7 +15,8 @@ WheelSimulationSensor::WheelSimulationSensor() : _shutdownRequested(false)
 
 void WheelSimulationSensor::readData(Queue& queue)
 {
-    _thread = std::thread([this, &queue]() {
+    _thread = std::thread([this, &queue, participant = Clock::Participant()]() {
+        participant.enter();
         simulateThread(queue);
         });
 }
@@ -26,15 +30,18 @@ void WheelSimulationSensor::shutdown()
 
 
 void WheelSimulationSensor::simulateThread(Sensor::Queue& queue) {
+    Tracer::setThreadName("sensor");
     // Set the periodicity in milliseconds for one rotation
     auto p = std::chrono::milliseconds(6000); // 4 seconds for one rotation
 
     // Get the reference time before entering the loop
-    auto reference_time = std::chrono::steady_clock::now();
+    auto reference_time = Clock::now();
 
     while (!_shutdownRequested) {
+        Instrumentation::LoopTimer loopTimer(Instrumentation::sensor);
+
         // Get the current absolute time
-        auto current_time = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now());
+        auto current_time = Clock::now();
 
         // Calculate the elapsed time since the start in milliseconds
         auto elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(current_time - reference_time);
@@ -46,10 +53,11 @@ void WheelSimulationSensor::simulateThread(Sensor::Queue& queue) {
 
         // Push the angle to the queue with current time
         if (!queue.push({ static_cast<float>(angle / 100.0), current_time, 0 })) {
-            BOOST_LOG_TRIVIAL(info) << "Inbound queue overflow" << std::endl;
+            AsyncLog::info("Inbound queue overflow");
         }
+        loopTimer.stop();
 
         // Sleep for a short duration to control the loop speed
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        Clock::sleepFor(std::chrono::milliseconds(5));
     }
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <chrono>
 #include <mutex>
 #include <fstream>
+#include <filesystem>
 #include <optional>
 #include <deque>
 #include <boost/lexical_cast.hpp>
@@ -41,12 +42,19 @@
 #include "TimeSeries.h"
 #include "Sensor.h"
 #include "ReplaySensor.h"
+#include "SampleRecording.h"
+#include "Clock.h"
 
 #include "SimulationSensor.h"
 #include "OilPumpMovementPredictor.h"
 #include "WheelMovementPredictor.h"
+#include "PhaseLockedMovementPredictor.h"
+#include "HarmonicMovementPredictor.h"
 
 #include "Monitor.h"
+#include "AsyncLog.h"
+#include "Instrumentation.h"
+#include "Tracer.h"
 #include "UsbSensor.h"
 //#include "TimeSeriesTest.h"
 #include <memory>
@@ -133,9 +141,33 @@ void initLogging(bool doLog)
     }
 
     logging::add_common_attributes();
+
+    // hot path log calls only enqueue records, a background thread writes them
+    if (doLog)
+        AsyncLog::start();
 }
 
+/* stops the log writer on every return from main, its thread would still be joinable at exit and terminate the process */
+struct LoggingGuard
+{
+    ~LoggingGuard()
+    {
+        AsyncLog::stop();
+    }
+};
 
+/* the string options select an implementation, a typo must not silently run the default one */
+bool checkChoice(const std::string& option, const std::string& value, std::initializer_list<const char*> choices)
+{
+    if (std::find(choices.begin(), choices.end(), value) != choices.end())
+        return true;
+
+    std::cerr << "Error: unknown --" << option << " " << value << ", expected one of:";
+    for (const char* choice : choices)
+        std::cerr << " " << choice;
+    std::cerr << std::endl;
+    return false;
+}
 
 
 
@@ -151,8 +183,6 @@ int main(int argc, char* argv[]) {
   //  TimeSeriesTest::testCrossFadeNoOverlap();
 
 
-    reference_time = std::chrono::steady_clock::now();
-
     float magnet_offset;
     int time_offset;  // Change to integer
     float scale;  // Change to integer
@@ -160,11 +190,30 @@ int main(int argc, char* argv[]) {
     bool simulate;
     bool replay;
     std::string replayFile;
+    int replayStart;
+    int replaySpin;
+    std::string convertRecording;
+    std::string clockMode;
+    bool headless;
+    int headlessFps;
+    int runTime;
+    std::string frameLog;
+    double clockSpeed;
     std::string videoFile;
     int zeroAnglePos;
     bool calibrationMode;
     bool wheelMode;
     bool doLog;
+    std::string periodicityMethod;
+    std::string predictorType;
+    int wakeupSamples;
+    int maxWakeupInterval;
+    int searchWindow;
+    int searchThreads;
+    std::string searchMethod;
+    bool stats;
+    int statsInterval;
+    std::string traceFile;
 
     po::options_description desc("Allowed options");
     desc.add_options()
@@ -174,13 +223,32 @@ int main(int argc, char* argv[]) {
         ("fullscreen,fs", po::value<bool>(&fullscreen)->default_value(true), "Fullscreen (bool)")
         ("simulate,s", po::value<bool>(&simulate)->default_value(false), "Simluate sensor data (bool)")
         ("replay,rp", po::value<bool>(&replay)->default_value(false), "Replay sensor data (bool)")
-        ("replay_file,rp_file", po::value<std::string>(&replayFile)->default_value("unspecified"), "Replay sensor data file (string)")
+        ("replay_file,rp_file", po::value<std::string>(&replayFile)->default_value("unspecified"), "Replay sensor data file, binary recording or CSV (string)")
+        ("replay_start,rps", po::value<int>(&replayStart)->default_value(0), "Start the replay this long after the first sample (integer milliseconds)")
+        ("replay_spin,rsp", po::value<int>(&replaySpin)->default_value(0), "Busy wait the last part of every replay sleep for sub-ms accurate sample release, costs one core (integer microseconds)")
+        ("clock,clk", po::value<std::string>(&clockMode)->default_value("realtime"), "Pipeline clock: realtime, accelerated or virtual (as fast as possible, deterministic), the latter two need replay or simulate (string)")
+        ("clock_speed,cs", po::value<double>(&clockSpeed)->default_value(10.0), "Speed of the accelerated clock relative to real time (float)")
+        ("convert_recording,cvr", po::value<std::string>(&convertRecording), "Convert a CSV recording to a binary recording next to it (.rec) and exit (string)")
+        ("headless,hl", po::value<bool>(&headless)->default_value(false), "Run the frame selection without window and GL context (bool)")
+        ("headless_fps,hfps", po::value<int>(&headlessFps)->default_value(60), "Frame rate of the headless renderer (integer)")
+        ("frame_log,fl", po::value<std::string>(&frameLog), "Headless renderer: write the time, frame and angle of every tick to this CSV file, none by default (string)")
+        ("run_time,rt", po::value<int>(&runTime)->default_value(0), "Headless renderer: stop after this long, 0 runs until killed (integer seconds)")
         ("plot_graph,g", po::value<bool>(&plot_graph)->default_value(false), "Plot the debugging graph (bool)")
         ("video_file,vf", po::value<std::string>(&videoFile), "Video file (string)")
         ("zero_angle_pos,zap", po::value<int>(&zeroAnglePos)->default_value(0), "Video file (integer milliseconds)")
         ("calibration_mode,cm", po::value<bool>(&calibrationMode)->default_value(false), "Calibration mode (bool)")
         ("wheel_mode,wm", po::value<bool>(&wheelMode)->default_value(false), "Wheel mode (bool)")
-        ("log,log", po::value<bool>(&doLog)->default_value(false), "Log (bool)");
+        ("log,log", po::value<bool>(&doLog)->default_value(false), "Log (bool)")
+        ("predictor,pr", po::value<std::string>(&predictorType)->default_value("batch"), "Oil pump predictor: batch, phase_locked or harmonic (string)")
+        ("periodicity_method,pm", po::value<std::string>(&periodicityMethod)->default_value("zero_crossing"), "Oil pump period detection of the batch predictor: zero_crossing or autocorrelation (string)")
+        ("wakeup_samples,ws", po::value<int>(&wakeupSamples)->default_value(20), "Run the prediction after this many new samples (integer)")
+        ("max_wakeup_interval,mwi", po::value<int>(&maxWakeupInterval)->default_value(50), "Run the prediction at least this often (integer milliseconds)")
+        ("search_window,sw", po::value<int>(&searchWindow)->default_value(300), "Batch predictor: phase offsets searched in both directions when matching the latest samples (integer milliseconds)")
+        ("search_threads,st", po::value<int>(&searchThreads)->default_value(1), "Batch predictor: threads for the phase offset search (integer)")
+        ("search_method,sm", po::value<std::string>(&searchMethod)->default_value("exhaustive"), "Batch predictor: phase offset search, exhaustive or pyramid (string)")
+        ("stats,sts", po::value<bool>(&stats)->default_value(false), "Record latency, allocation and queue depth statistics of the sensor, predictor and render loops (bool)")
+        ("stats_interval,sti", po::value<int>(&statsInterval)->default_value(10), "Print the statistics this often, 0 only on shutdown (integer seconds)")
+        ("trace_file,tf", po::value<std::string>(&traceFile), "Record a timeline of the pipeline threads and write it as Chrome trace JSON on exit (string)");
 
 
    
@@ -190,9 +258,32 @@ int main(int argc, char* argv[]) {
     po::notify(vm);
 
     initLogging(doLog);
+    LoggingGuard loggingGuard;
+
+    if (!convertRecording.empty())
+    {
+        std::string recordingFile = std::filesystem::path(convertRecording).replace_extension(".rec").string();
+        return SampleRecording::convertCsv(convertRecording, recordingFile) ? 0 : 1;
+    }
    
 
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+    if (!checkChoice("clock", clockMode, { "realtime", "accelerated", "virtual" }) ||
+        !checkChoice("predictor", predictorType, { "batch", "phase_locked", "harmonic" }) ||
+        !checkChoice("periodicity_method", periodicityMethod, { "zero_crossing", "autocorrelation" }) ||
+        !checkChoice("search_method", searchMethod, { "exhaustive", "pyramid" }))
+        return 1;
+
+    // the period detection and the offset search are part of the batch predictor only
+    if (wheelMode || predictorType != "batch")
+    {
+        for (auto option : { "periodicity_method", "search_window", "search_threads", "search_method" })
+        {
+            if (!vm[option].defaulted())
+                std::cerr << "Warning: --" << option << " only applies to the batch oil pump predictor and is ignored" << std::endl;
+        }
+    }
+
+    if (!headless && SDL_Init(SDL_INIT_VIDEO) < 0) {
         BOOST_LOG_TRIVIAL(info) << "SDL could not initialize! SDL Error:\n" << SDL_GetError();
     }
 
@@ -204,8 +295,28 @@ int main(int argc, char* argv[]) {
         BOOST_LOG_TRIVIAL(trace) << "Time Offset: " << time_offset << std::endl;
     }
 
+    auto mode = clockMode == "virtual" ? Clock::Mode::Virtual : clockMode == "accelerated" ? Clock::Mode::Accelerated : Clock::Mode::RealTime;
+    if (mode != Clock::Mode::RealTime && !replay && !simulate)
+    {
+        std::cerr << "Error: the " << clockMode << " clock needs replayed or simulated sensor data" << std::endl;
+        return 1;
+    }
+    Clock::setMode(mode, clockSpeed);
+    reference_time = Clock::now();
+
+    // holds the virtual clock until sensor and predictor threads are running
+    std::optional<Clock::Participant> startup(std::in_place);
+
     if (replay)
-        g_sensor = new ReplaySensor(replayFile);
+    {
+        auto replaySensor = new ReplaySensor(replayFile, std::chrono::milliseconds(replayStart), std::chrono::microseconds(replaySpin));
+        if (!replaySensor->open())
+        {
+            std::cerr << "Error: could not replay " << replayFile << std::endl;
+            return 1;
+        }
+        g_sensor = replaySensor;
+    }
 
     if( !replay && simulate)
         if (wheelMode)
@@ -221,12 +332,18 @@ int main(int argc, char* argv[]) {
         g_sensor = new UsbSensor(magnet_offset);
 
     //magnetOffset = magnet_offset;
+
+    if (stats)
+        Instrumentation::start(std::chrono::seconds(statsInterval));
+    if (!traceFile.empty())
+        Tracer::start(traceFile);
     
     Sensor::Queue inbound_queue;
     g_sensor->readData(inbound_queue);
 
     if (calibrationMode)
     {
+        startup.reset();
         while (true)
         {
             inbound_queue.consume_all([](const TimeSeries::Sample& sample)
@@ -247,8 +364,16 @@ int main(int argc, char* argv[]) {
    
     if (!wheelMode)
     {
-        predictor = std::unique_ptr<AbstractMovementPredictor>(new OilPumpMovementPredictor(*g_sensor, std::chrono::milliseconds(1000), 
+        auto method = periodicityMethod == "autocorrelation" ? OilPumpMovementPredictor::PeriodicityMethod::Autocorrelation : OilPumpMovementPredictor::PeriodicityMethod::ZeroCrossing;
+        if (predictorType == "phase_locked")
+            predictor = std::unique_ptr<AbstractMovementPredictor>(new PhaseLockedMovementPredictor(*g_sensor, std::chrono::milliseconds(1000),
+                                                                std::chrono::milliseconds(80), std::chrono::milliseconds(time_offset)));
+        else if (predictorType == "harmonic")
+            predictor = std::unique_ptr<AbstractMovementPredictor>(new HarmonicMovementPredictor(*g_sensor, std::chrono::milliseconds(1000),
                                                                 std::chrono::milliseconds(80), std::chrono::milliseconds(time_offset)));
+        else
+            predictor = std::unique_ptr<AbstractMovementPredictor>(new OilPumpMovementPredictor(*g_sensor, std::chrono::milliseconds(1000), 
+                                                                std::chrono::milliseconds(80), std::chrono::milliseconds(time_offset), method));
         renderer = std::unique_ptr<OpenGLRenderer>(new OilPumpRenderer(videoFile, zeroAnglePos, fullscreen, scale, std::chrono::milliseconds(time_offset)));
     }
     else
@@ -258,15 +383,21 @@ int main(int argc, char* argv[]) {
 
     if (predictor)
     {
-        predictor->predictMovement(inbound_queue, [&renderer](const TimeSeries& ts, std::chrono::milliseconds periodicity, TimeSeries::Timestamp lastPeriodBegin, std::chrono::milliseconds curRoationOffset, const std::string& overlay)
+        predictor->setWakeup(wakeupSamples, std::chrono::milliseconds(maxWakeupInterval));
+        auto search = searchMethod == "pyramid" ? AbstractMovementPredictor::CorrelationSearch::Pyramid : AbstractMovementPredictor::CorrelationSearch::Exhaustive;
+        predictor->setCorrelationSearch(std::chrono::milliseconds(searchWindow), std::max(searchThreads, 1), search);
+        predictor->predictMovement(inbound_queue, [&renderer](const PhaseModel& model, std::chrono::milliseconds periodicity, TimeSeries::Timestamp lastPeriodBegin, std::chrono::milliseconds curRoationOffset, const std::string& overlay)
             {
-                renderer->feedData(ts, periodicity, lastPeriodBegin, curRoationOffset, overlay);
+                renderer->feedData(model, periodicity, lastPeriodBegin, curRoationOffset, overlay);
             },
             [&monitor](const std::string& title, TimeSeries& ts) {
                 monitor.addData(title, ts);
             });
     }
     monitor.monitor();
+    if (headless)
+        renderer->setHeadless(std::chrono::milliseconds(1000 / std::max(headlessFps, 1)), std::chrono::seconds(runTime), frameLog);
+    startup.reset();
     renderer->render([&monitor](const std::string& title, TimeSeries& ts) {
         monitor.addData(title, ts);
         });
@@ -282,6 +413,8 @@ int main(int argc, char* argv[]) {
         predictor->shutdown();
     monitor.shutdown();
     g_sensor->shutdown();
+    Instrumentation::stop();
+    Tracer::stop();
 
     return 0;
 }
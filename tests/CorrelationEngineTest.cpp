@@ -0,0 +1,91 @@
+#include "CorrelationEngineTest.h"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+#include "CorrelationEngine.h"
+#include "TimeSeries.h"
+
+
+     static std::vector<float> randomAngles(size_t n, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> dist(-20.0f, 20.0f);
+        std::vector<float> angles(n);
+        for (auto& angle : angles)
+            angle = dist(rng);
+        return angles;
+     }
+
+     // noisy sine with the given period, 1 sample per ms
+     static TimeSeries noisySine(size_t n, double period, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::normal_distribution<float> noise(0.0f, 0.3f);
+        TimeSeries ts;
+        for (size_t t = 0; t < n; ++t)
+            ts.add(20.0f * (float)std::sin(2.0 * std::numbers::pi * t / period) + noise(rng), TimeSeries::Timestamp(std::chrono::milliseconds(t)));
+        return ts;
+     }
+
+     void CorrelationEngineTest::testSlidingDotProducts() {
+        CorrelationEngine engine;
+        std::vector<double> actual;
+
+        // small sizes are computed directly, the large ones via FFT
+        struct Case { size_t signalSize, patternSize, lags; };
+        for (auto [signalSize, patternSize, lags] : { Case{ 10, 3, 8 }, Case{ 5, 8, 5 }, Case{ 100, 17, 120 },
+                Case{ 3000, 500, 2000 }, Case{ 9000, 500, 6000 }, Case{ 4096, 1024, 3073 } }) {
+            auto signal = randomAngles(signalSize, 1);
+            auto pattern = randomAngles(patternSize, 2);
+
+            engine.slidingDotProducts(signal.data(), signalSize, pattern.data(), patternSize, lags, actual);
+            assert(actual.size() == lags);
+
+            // the signal is treated as zero beyond its end
+            for (size_t s = 0; s < lags; ++s) {
+                double expected = 0.0;
+                double magnitude = 0.0;
+                for (size_t k = 0; k < patternSize && s + k < signalSize; ++k) {
+                    expected += (double)signal[s + k] * (double)pattern[k];
+                    magnitude += std::abs((double)signal[s + k] * (double)pattern[k]);
+                }
+                assert(std::abs(actual[s] - expected) <= 1e-9 * std::max(1.0, magnitude));
+            }
+        }
+     }
+
+     void CorrelationEngineTest::testBestMatchDirectSearch() {
+        CorrelationEngine engine;
+
+        for (unsigned trial = 0; trial < 20; ++trial) {
+            double period = 2000.0 + trial * 53.0;
+            auto ts = noisySine(9000, period, trial);
+            auto view = ts.view();
+            auto pattern = view.slice(view.time(view.size() - 1) - std::chrono::milliseconds(500), view.time(view.size() - 1));
+            auto shift = -std::chrono::milliseconds((int)period);
+
+            for (auto window : { std::chrono::milliseconds(300), std::chrono::milliseconds(1500) }) {
+                auto actual = view.bestMatch(window, pattern, shift, engine);
+
+                // direct search: slice and compare for every offset
+                TimeSeries shifted(pattern);
+                shifted.shift(shift);
+                float bestSimilarity = 0.0f;
+                auto expected = std::chrono::milliseconds(0);
+                for (auto i = -window; i < window; i += std::chrono::milliseconds(1)) {
+                    auto slice = view.slice(shifted.time(0) + i, shifted.time(shifted.size() - 1) + i);
+                    if (std::abs(static_cast<int>(slice.size()) - static_cast<int>(shifted.size())) > 2)
+                        continue;
+                    float similarity = slice.similarity(shifted);
+                    if (similarity > bestSimilarity) {
+                        bestSimilarity = similarity;
+                        expected = i;
+                    }
+                }
+
+                // the sums are computed differently, near ties may go either way
+                assert(std::abs((actual - expected).count()) <= 1);
+            }
+        }
+     }
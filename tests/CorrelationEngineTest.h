@@ -0,0 +1,10 @@
+#pragma once
+#include <iostream>
+#include <cassert>
+#include "CorrelationEngine.h"
+
+class CorrelationEngineTest {
+public:
+    static void testSlidingDotProducts();
+    static void testBestMatchDirectSearch();
+};
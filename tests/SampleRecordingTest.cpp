@@ -0,0 +1,149 @@
+#include "SampleRecordingTest.h"
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include "SampleRecording.h"
+#include "TimeSeries.h"
+
+
+     // several index intervals with irregular spacing, a gap and a step back in time
+     static TimeSeries testSamples() {
+        TimeSeries ts;
+        auto time = TimeSeries::Timestamp(std::chrono::milliseconds(1000000));
+        for (int i = 0; i < 5000; ++i) {
+            time += std::chrono::milliseconds(i % 7 == 0 ? 23 : 10);
+            if (i == 3000)
+                time += std::chrono::milliseconds(100000);
+            if (i == 4000)
+                time -= std::chrono::milliseconds(5);
+            ts.add(std::sin(i * 0.01f) * 30.0f, time);
+        }
+        return ts;
+     }
+
+     static std::string testFileName() {
+        return (std::filesystem::temp_directory_path() / "SampleRecordingTest.rec").string();
+     }
+
+     void SampleRecordingTest::testRoundTrip() {
+        auto samples = testSamples();
+        assert(SampleRecording::write(testFileName(), samples));
+        assert(SampleRecording::isRecording(testFileName()));
+
+        SampleRecording recording;
+        assert(recording.open(testFileName()));
+        assert(recording.size() == samples.size());
+        assert(recording.start() == samples.time(0));
+        assert(recording.end() == samples.time(samples.size() - 1));
+
+        // the angles are stored raw, so they are bit identical
+        auto cursor = recording.begin();
+        size_t n = 0;
+        while (cursor.next()) {
+            assert(cursor.time() == samples.time(n));
+            assert(cursor.angle() == samples.angle(n));
+            n++;
+        }
+        assert(n == samples.size());
+        assert(cursor.atEnd());
+        assert(!cursor.next());
+
+        std::filesystem::remove(testFileName());
+     }
+
+     void SampleRecordingTest::testSeek() {
+        // only the ordered part, seek assumes increasing timestamps
+        auto samples = TimeSeries(testSamples().view().subView(0, 4000));
+        assert(SampleRecording::write(testFileName(), samples));
+        SampleRecording recording;
+        assert(recording.open(testFileName()));
+
+        // exactly at and just before every 37th sample, which covers the index entries as well
+        for (size_t i = 0; i < samples.size(); i += 37) {
+            for (int delta : { -1, 0 }) {
+                auto time = samples.time(i) + std::chrono::milliseconds(delta);
+                size_t expected = std::lower_bound(samples.timestamps().begin(), samples.timestamps().end(), time) - samples.timestamps().begin();
+
+                auto cursor = recording.seek(time);
+                assert(cursor.position() == expected);
+                assert(cursor.next());
+                assert(cursor.time() == samples.time(expected));
+                assert(cursor.angle() == samples.angle(expected));
+            }
+        }
+
+        assert(!recording.seek(samples.time(samples.size() - 1) + std::chrono::milliseconds(1)).next());
+        auto first = recording.seek(TimeSeries::Timestamp());
+        assert(first.next() && first.time() == samples.time(0));
+
+        std::filesystem::remove(testFileName());
+     }
+
+     void SampleRecordingTest::testEmpty() {
+        assert(SampleRecording::write(testFileName(), TimeSeries()));
+        SampleRecording recording;
+        assert(recording.open(testFileName()));
+        assert(recording.empty());
+        assert(!recording.begin().next());
+        assert(!recording.seek(TimeSeries::Timestamp()).next());
+
+        std::filesystem::remove(testFileName());
+     }
+
+     // writes the bytes of a recording to the test file
+     static void writeBytes(const std::vector<std::byte>& bytes) {
+        std::ofstream file(testFileName(), std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+     }
+
+     void SampleRecordingTest::testCorrupt() {
+        auto samples = testSamples();
+        const auto valid = SampleRecording::encode(samples);
+        auto header = [](std::vector<std::byte>& bytes) { return reinterpret_cast<SampleRecording::Header*>(bytes.data()); };
+        auto entry = [&header](std::vector<std::byte>& bytes, size_t k) {
+            return reinterpret_cast<SampleRecording::IndexEntry*>(bytes.data() + header(bytes)->indexOffset) + k;
+        };
+
+        // every one of these is rejected by open
+        std::vector<std::function<void(std::vector<std::byte>&)>> corruptions = {
+            [](std::vector<std::byte>& bytes) { bytes.resize(sizeof(SampleRecording::Header) - 1); },
+            [](std::vector<std::byte>& bytes) { bytes.resize(bytes.size() - 1); },
+            [&header](std::vector<std::byte>& bytes) { header(bytes)->indexCount = std::numeric_limits<uint64_t>::max() / sizeof(SampleRecording::IndexEntry) + 1; },
+            [&header](std::vector<std::byte>& bytes) { header(bytes)->indexOffset = std::numeric_limits<uint64_t>::max() - 7; },
+            [&header](std::vector<std::byte>& bytes) { header(bytes)->sampleCount *= 2; },
+            [&header](std::vector<std::byte>& bytes) { header(bytes)->indexInterval = 0; },
+            [&entry, &header](std::vector<std::byte>& bytes) { entry(bytes, 1)->offset = header(bytes)->indexOffset + 8; },
+            [&entry](std::vector<std::byte>& bytes) { entry(bytes, 2)->offset = 0; },
+            [&entry](std::vector<std::byte>& bytes) { entry(bytes, 3)->sample = 0; },
+            [&entry](std::vector<std::byte>& bytes) { entry(bytes, 4)->offset = entry(bytes, 3)->offset + 5; },
+        };
+        for (auto& corrupt : corruptions) {
+            auto bytes = valid;
+            corrupt(bytes);
+            writeBytes(bytes);
+            SampleRecording recording;
+            assert(!recording.open(testFileName()));
+        }
+
+        // a run of continuation bytes in the last samples is only found while decoding, it ends the recording there
+        auto bytes = valid;
+        auto firstCorrupt = header(bytes)->indexOffset - 12;
+        std::memset(bytes.data() + firstCorrupt, 0xff, header(bytes)->indexOffset - firstCorrupt);
+        writeBytes(bytes);
+        SampleRecording recording;
+        assert(recording.open(testFileName()));
+        auto cursor = recording.begin();
+        size_t n = 0;
+        while (cursor.next())
+            n++;
+        assert(n < samples.size() && n + 3 >= samples.size());
+        assert(cursor.atEnd());
+
+        std::filesystem::remove(testFileName());
+     }
@@ -0,0 +1,12 @@
+#pragma once
+#include <iostream>
+#include <cassert>
+#include "SampleRecording.h"
+
+class SampleRecordingTest {
+public:
+    static void testRoundTrip();
+    static void testSeek();
+    static void testEmpty();
+    static void testCorrupt();
+};
@@ -0,0 +1,109 @@
+#include "SimdKernelsTest.h"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "SimdKernels.h"
+#include "TimeSeries.h"
+
+
+     // every level up to the supported one, scalar first
+     static std::vector<SimdKernels::Level> testLevels() {
+        std::vector<SimdKernels::Level> levels = { SimdKernels::Level::Scalar };
+        if (SimdKernels::supportedLevel() >= SimdKernels::Level::SSE2)
+            levels.push_back(SimdKernels::Level::SSE2);
+        if (SimdKernels::supportedLevel() >= SimdKernels::Level::AVX2)
+            levels.push_back(SimdKernels::Level::AVX2);
+        return levels;
+     }
+
+     static std::vector<float> randomAngles(size_t n, float min, float max, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> dist(min, max);
+        std::vector<float> angles(n);
+        for (auto& angle : angles)
+            angle = dist(rng);
+        return angles;
+     }
+
+     void SimdKernelsTest::testSumOfSquaredDifferences() {
+        auto initialLevel = SimdKernels::level();
+
+        // lengths around the vector widths, so the remainder loops are covered as well
+        for (size_t n : { 0, 1, 3, 4, 7, 8, 15, 16, 17, 33, 1000 }) {
+            auto a = randomAngles(n, -20.0f, 20.0f, 1);
+            auto b = randomAngles(n, -20.0f, 20.0f, 2);
+
+            SimdKernels::setLevel(SimdKernels::Level::Scalar);
+            float expected = SimdKernels::sumOfSquaredDifferences(a.data(), b.data(), n);
+
+            for (auto level : testLevels()) {
+                SimdKernels::setLevel(level);
+                float actual = SimdKernels::sumOfSquaredDifferences(a.data(), b.data(), n);
+                // the vectorized reductions sum in a different order
+                assert(std::abs(actual - expected) <= 1e-5f * std::max(1.0f, expected));
+            }
+        }
+
+        SimdKernels::setLevel(initialLevel);
+     }
+
+     void SimdKernelsTest::testCrossFade() {
+        auto initialLevel = SimdKernels::level();
+
+        for (size_t n : { 1, 2, 3, 4, 5, 8, 9, 17, 1000 }) {
+            auto fadeOut = randomAngles(n, -20.0f, 20.0f, 3);
+            auto fadeIn = randomAngles(n, -20.0f, 20.0f, 4);
+            std::vector<float> expected(n);
+            std::vector<float> actual(n);
+
+            SimdKernels::setLevel(SimdKernels::Level::Scalar);
+            SimdKernels::crossFade(fadeOut.data(), fadeIn.data(), expected.data(), n);
+
+            // starts with fadeOut, ends with fadeIn
+            assert(std::abs(expected.back() - fadeIn.back()) < 1e-4f);
+            if (n > 1)
+                assert(expected.front() == fadeOut.front());
+
+            // no reduction, so the results are bit identical
+            for (auto level : testLevels()) {
+                SimdKernels::setLevel(level);
+                SimdKernels::crossFade(fadeOut.data(), fadeIn.data(), actual.data(), n);
+                assert(actual == expected);
+            }
+        }
+
+        SimdKernels::setLevel(initialLevel);
+     }
+
+     void SimdKernelsTest::testInterpolateAngles() {
+        auto initialLevel = SimdKernels::level();
+
+        // covers the roll over in both directions
+        size_t n = 1001;
+        auto lower = randomAngles(n, 0.0f, 360.0f, 5);
+        auto upper = randomAngles(n, 0.0f, 360.0f, 6);
+        lower[0] = 359.0f; upper[0] = 1.0f;
+        lower[1] = 1.0f; upper[1] = 359.0f;
+        std::vector<float> distanceLower(n);
+        std::vector<float> distanceUpper(n);
+        for (size_t i = 0; i < n; ++i) {
+            distanceLower[i] = (float)(1 + i % 7);
+            distanceUpper[i] = (float)(1 + i % 5);
+        }
+
+        // matches TimeSeries::interpolateAngle exactly at every level
+        std::vector<float> actual(n);
+        for (auto level : testLevels()) {
+            SimdKernels::setLevel(level);
+            SimdKernels::interpolateAngles(lower.data(), upper.data(), distanceLower.data(), distanceUpper.data(), actual.data(), n);
+            for (size_t i = 0; i < n; ++i) {
+                float expected = TimeSeries::interpolateAngle(lower[i], std::chrono::milliseconds((int)distanceLower[i]),
+                    upper[i], std::chrono::milliseconds((int)distanceUpper[i]));
+                assert(actual[i] == expected);
+            }
+        }
+
+        SimdKernels::setLevel(initialLevel);
+     }
@@ -0,0 +1,11 @@
+#pragma once
+#include <iostream>
+#include <cassert>
+#include "SimdKernels.h"
+
+class SimdKernelsTest {
+public:
+    static void testSumOfSquaredDifferences();
+    static void testCrossFade();
+    static void testInterpolateAngles();
+};
@@ -0,0 +1,55 @@
+#include "ThreadPoolTest.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+#include "CorrelationEngine.h"
+#include "ThreadPool.h"
+#include "TimeSeries.h"
+
+
+     // noisy sine with the given period, 1 sample per ms
+     static TimeSeries noisySine(size_t n, double period, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::normal_distribution<float> noise(0.0f, 0.3f);
+        TimeSeries ts;
+        for (size_t t = 0; t < n; ++t)
+            ts.add(20.0f * (float)std::sin(2.0 * std::numbers::pi * t / period) + noise(rng), TimeSeries::Timestamp(std::chrono::milliseconds(t)));
+        return ts;
+     }
+
+     void ThreadPoolTest::testParallelFor() {
+        ThreadPool pool(4);
+
+        // every item exactly once, also for fewer items than threads and repeated loops
+        for (size_t count : { 0, 1, 3, 4, 100, 10000 }) {
+            std::vector<std::atomic<int>> calls(count);
+            pool.parallelFor(count, [&calls](size_t i) { calls[i]++; });
+            for (const auto& c : calls)
+                assert(c == 1);
+        }
+     }
+
+     void ThreadPoolTest::testBestMatchParallel() {
+        CorrelationEngine engine;
+        ThreadPool pool(4);
+
+        for (unsigned trial = 0; trial < 20; ++trial) {
+            double period = 2000.0 + trial * 37.0;
+            auto ts = noisySine(9000, period, trial + 100);
+            auto view = ts.view();
+            auto pattern = view.slice(view.time(view.size() - 1) - std::chrono::milliseconds(500), view.time(view.size() - 1));
+            auto shift = -std::chrono::milliseconds((int)period);
+
+            // one block, several blocks and a partial last block
+            for (auto window : { std::chrono::milliseconds(300), std::chrono::milliseconds(1500), std::chrono::milliseconds(3000) }) {
+                auto serial = view.bestMatch(window, pattern, shift, engine);
+                auto parallel = view.bestMatch(window, pattern, shift, engine, &pool);
+                // the blocks do not depend on the threads, so the results are identical
+                assert(serial == parallel);
+            }
+        }
+     }
@@ -0,0 +1,10 @@
+#pragma once
+#include <iostream>
+#include <cassert>
+#include "ThreadPool.h"
+
+class ThreadPoolTest {
+public:
+    static void testParallelFor();
+    static void testBestMatchParallel();
+};
@@ -0,0 +1,40 @@
+#include "TimeSeriesPyramidTest.h"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include "CorrelationEngine.h"
+#include "TimeSeries.h"
+#include "TimeSeriesPyramid.h"
+
+
+     void TimeSeriesPyramidTest::testBestMatchAgreesWithExhaustive() {
+        // The pyramid is a heuristic: this covers the signals of the oil pump (two harmonics, noise, a drifting period),
+        // for which the coarse levels keep the best offset among their candidates
+        std::mt19937 rng(3);
+        CorrelationEngine engine;
+        for (int trial = 0; trial < 60; ++trial) {
+            std::normal_distribution<float> noise(0.0f, 0.2f * (trial % 4));
+            double period = 1500.0 + trial * 97.0;
+            double drift = 0.03 * (trial % 5);
+
+            TimeSeries ts;
+            for (int t = 0; t < (int)(2.1 * period) + 600; ++t) {
+                double phase = 2.0 * std::numbers::pi * t / period * (1.0 + drift * t / (3.0 * period));
+                ts.add(20.0f * (float)std::sin(phase) + 8.0f * (float)std::sin(2.0 * phase + 0.5) + noise(rng), TimeSeries::Timestamp(std::chrono::milliseconds(t)));
+            }
+
+            auto view = ts.view();
+            auto pattern = view.slice(view.time(view.size() - 1) - std::chrono::milliseconds(500), view.time(view.size() - 1));
+            TimeSeriesPyramid seriesPyramid(view);
+            TimeSeriesPyramid patternPyramid(pattern);
+            auto shift = -std::chrono::milliseconds((int)period);
+
+            for (int window : { 300, 1000, (int)period / 2 }) {
+                auto exhaustive = view.bestMatch(std::chrono::milliseconds(window), pattern, shift, engine);
+                auto pyramid = seriesPyramid.bestMatch(std::chrono::milliseconds(window), patternPyramid, shift);
+                assert(pyramid == exhaustive);
+            }
+        }
+     }
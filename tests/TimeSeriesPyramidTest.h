@@ -0,0 +1,9 @@
+#pragma once
+#include <iostream>
+#include <cassert>
+#include "TimeSeriesPyramid.h"
+
+class TimeSeriesPyramidTest {
+public:
+    static void testBestMatchAgreesWithExhaustive();
+};
@@ -3,6 +3,7 @@
 #include <cassert>
 #include <chrono>
 #include "TimeSeries.h" // Include the TimeSeries header file
+#include "RingTimeSeries.h"
 
 
      void TimeSeriesTest::testSliceOverlap() {
@@ -10,12 +11,12 @@
         TimeSeries ts;
 
         // Define fixed timestamps for sample data
-        auto startTime = std::chrono::steady_clock::time_point(std::chrono::seconds(0));
+        auto startTime = TimeSeries::Timestamp(std::chrono::seconds(0));
         auto timeIncrement = std::chrono::seconds(1);
 
         // Add sample data to the time series with fixed timestamps
         for (int i = 1; i <= 5; ++i) {
-            ts.add({ static_cast<float>(i), startTime + (i - 1) * timeIncrement });
+            ts.add(static_cast<float>(i), startTime + (i - 1) * timeIncrement);
         }
 
         // Slice the time series with overlap
@@ -24,11 +25,11 @@
         auto slicedTs = ts.slice(startSliceTime, endSliceTime);
 
         // Assertion tests
-        assert(slicedTs.getVector().size() == 4); // Check if the sliced time series has 4 samples
-        assert(std::get<0>(slicedTs.getVector()[0]) == 1.0f); // Check the first sample after slicing
-        assert(std::get<0>(slicedTs.getVector()[1]) == 2.0f); // Check the second sample after slicing
-        assert(std::get<0>(slicedTs.getVector()[2]) == 3.0f); // Check the third sample after slicing
-        //assert(std::get<0>(slicedTs.getVector()[3]) == 4.0f); // Check the fourth sample after slicing
+        assert(slicedTs.size() == 4); // Check if the sliced time series has 4 samples
+        assert(slicedTs.angle(0) == 1.0f); // Check the first sample after slicing
+        assert(slicedTs.angle(1) == 2.0f); // Check the second sample after slicing
+        assert(slicedTs.angle(2) == 3.0f); // Check the third sample after slicing
+        //assert(slicedTs.angle(3) == 4.0f); // Check the fourth sample after slicing
     }
 
      void TimeSeriesTest::testSlicePartialOverlap() {
@@ -36,24 +37,24 @@
         TimeSeries ts;
 
         // Define fixed timestamps for sample data
-        auto startTime = std::chrono::steady_clock::time_point(std::chrono::seconds(3));
+        auto startTime = TimeSeries::Timestamp(std::chrono::seconds(3));
         auto timeIncrement = std::chrono::seconds(1);
 
         // Add sample data to the time series with fixed timestamps
         for (int i = 1; i <= 5; ++i) {
-            ts.add({ static_cast<float>(i), startTime + (i - 1) * timeIncrement });
+            ts.add(static_cast<float>(i), startTime + (i - 1) * timeIncrement);
         }
 
         // Slice the time series with partial overlap in both directions
-        auto startSliceTime = std::chrono::steady_clock::time_point(std::chrono::seconds(1)); 
-        auto endSliceTime = std::chrono::steady_clock::time_point(std::chrono::seconds(4));
+        auto startSliceTime = TimeSeries::Timestamp(std::chrono::seconds(1)); 
+        auto endSliceTime = TimeSeries::Timestamp(std::chrono::seconds(4));
         auto slicedTs = ts.slice(startSliceTime, endSliceTime);
 
         // Assertion tests
-        assert(slicedTs.getVector().size() == 2); // Check if the sliced time series has 4 samples
+        assert(slicedTs.size() == 2); // Check if the sliced time series has 4 samples
      
-        assert(std::get<0>(slicedTs.getVector()[0]) == 1.0f); // Check the third sample after slicing
-        assert(std::get<0>(slicedTs.getVector()[1]) == 2.0f); // Check the fourth sample after slicing
+        assert(slicedTs.angle(0) == 1.0f); // Check the third sample after slicing
+        assert(slicedTs.angle(1) == 2.0f); // Check the fourth sample after slicing
     }
 
      void TimeSeriesTest::testSliceNoOverlap() {
@@ -61,21 +62,21 @@
         TimeSeries ts;
 
         // Define fixed timestamps for sample data
-        auto startTime = std::chrono::steady_clock::time_point(std::chrono::seconds(10));
+        auto startTime = TimeSeries::Timestamp(std::chrono::seconds(10));
         auto timeIncrement = std::chrono::seconds(1);
 
         // Add sample data to the time series with fixed timestamps
         for (int i = 1; i <= 5; ++i) {
-            ts.add({ static_cast<float>(i), startTime + (i - 1) * timeIncrement });
+            ts.add(static_cast<float>(i), startTime + (i - 1) * timeIncrement);
         }
 
         // Slice the time series with no overlap before and after
-        auto startSliceTime = std::chrono::steady_clock::time_point(std::chrono::seconds(1));
-        auto endSliceTime = std::chrono::steady_clock::time_point(std::chrono::seconds(4));
+        auto startSliceTime = TimeSeries::Timestamp(std::chrono::seconds(1));
+        auto endSliceTime = TimeSeries::Timestamp(std::chrono::seconds(4));
         auto slicedTs = ts.slice(startSliceTime, endSliceTime);
 
         // Assertion tests
-        assert(slicedTs.getVector().size() == 0); 
+        assert(slicedTs.size() == 0); 
     }
 
 
@@ -84,24 +85,24 @@
           TimeSeries ts1, ts2;
 
           // Define fixed timestamps for sample data
-          auto startTime = std::chrono::steady_clock::time_point(std::chrono::seconds(0));
+          auto startTime = TimeSeries::Timestamp(std::chrono::seconds(0));
           auto timeIncrement = std::chrono::seconds(1);
 
           // Add sample data to the first time series with fixed timestamps
           for (int i = 1; i <= 10; ++i) {
-              ts1.add({ 1.0, startTime + (i - 1) * timeIncrement });
+              ts1.add(1.0, startTime + (i - 1) * timeIncrement);
           }
 
           // Add sample data to the second time series with fixed timestamps
           for (int i = 4; i <= 20; ++i) {
-              ts2.add({ 10.0, startTime + (i - 1) * timeIncrement });
+              ts2.add(10.0, startTime + (i - 1) * timeIncrement);
           }
 
           // Perform crossFade between the two time series
           auto resultTs = ts1.crossFade(ts2);
 
           // Assertion tests
-          auto& resultVector = resultTs.getVector();
+          auto& resultVector = resultTs;
           assert(resultVector.size() == 18); // Check if the result time series has 8 samples
      }
 
@@ -110,30 +111,30 @@
          TimeSeries ts1, ts2;
 
          // Define fixed timestamps for sample data
-         auto startTime = std::chrono::steady_clock::time_point(std::chrono::seconds(0));
+         auto startTime = TimeSeries::Timestamp(std::chrono::seconds(0));
          auto timeIncrement = std::chrono::seconds(1);
 
          // Add sample data to the first time series with fixed timestamps
          for (int i = 1; i <= 5; ++i) {
-             ts1.add({ static_cast<float>(i), startTime + (i - 1) * timeIncrement });
+             ts1.add(static_cast<float>(i), startTime + (i - 1) * timeIncrement);
          }
 
          // Add sample data to the second time series with fixed timestamps
          for (int i = 6; i <= 10; ++i) {
-             ts2.add({ static_cast<float>(i), startTime + (i - 1) * timeIncrement });
+             ts2.add(static_cast<float>(i), startTime + (i - 1) * timeIncrement);
          }
 
          // Perform crossFade between the two time series
          auto resultTs = ts1.crossFade(ts2);
 
          // Assertion tests
-         auto& resultVector = resultTs.getVector();
+         auto& resultVector = resultTs;
          assert(resultVector.size() == 10); // Check if the result time series has 10 samples
-         assert(std::get<0>(resultVector[4]) == 6.0f); // Check the first sample after crossFade
-         assert(std::get<0>(resultVector[5]) == 7.0f); // Check the second sample after crossFade
-         assert(std::get<0>(resultVector[6]) == 8.0f); // Check the third sample after crossFade
-         assert(std::get<0>(resultVector[7]) == 9.0f); // Check the fourth sample after crossFade
-         assert(std::get<0>(resultVector[8]) == 10.0f); // Check the fifth sample after crossFade
+         assert(resultVector.angle(4) == 6.0f); // Check the first sample after crossFade
+         assert(resultVector.angle(5) == 7.0f); // Check the second sample after crossFade
+         assert(resultVector.angle(6) == 8.0f); // Check the third sample after crossFade
+         assert(resultVector.angle(7) == 9.0f); // Check the fourth sample after crossFade
+         assert(resultVector.angle(8) == 10.0f); // Check the fifth sample after crossFade
      }
 
       void TimeSeriesTest::testCrossFadeNoOverlap() {
@@ -141,34 +142,65 @@
           TimeSeries ts1, ts2;
 
           // Define fixed timestamps for sample data
-          auto startTime = std::chrono::steady_clock::time_point(std::chrono::seconds(0));
+          auto startTime = TimeSeries::Timestamp(std::chrono::seconds(0));
           auto timeIncrement = std::chrono::seconds(1);
 
           // Add sample data to the first time series with fixed timestamps
           for (int i = 1; i <= 5; ++i) {
-              ts1.add({ static_cast<float>(i), startTime + (i - 1) * timeIncrement });
+              ts1.add(static_cast<float>(i), startTime + (i - 1) * timeIncrement);
           }
 
           // Add sample data to the second time series with fixed timestamps
           for (int i = 6; i <= 10; ++i) {
-              ts2.add({ static_cast<float>(i), startTime + (i - 1) * timeIncrement });
+              ts2.add(static_cast<float>(i), startTime + (i - 1) * timeIncrement);
           }
 
           // Perform crossFade between the two time series
           auto resultTs = ts1.crossFade(ts2);
 
           // Assertion tests
-          auto& resultVector = resultTs.getVector();
+          auto& resultVector = resultTs;
           assert(resultVector.size() == 10); // Check if the result time series has 10 samples
-          assert(std::get<0>(resultVector[0]) == 1.0f); // Check the first sample after crossFade
-          assert(std::get<0>(resultVector[1]) == 2.0f); // Check the second sample after crossFade
-          assert(std::get<0>(resultVector[2]) == 3.0f); // Check the third sample after crossFade
-          assert(std::get<0>(resultVector[3]) == 4.0f); // Check the fourth sample after crossFade
-          assert(std::get<0>(resultVector[4]) == 5.0f); // Check the fifth sample after crossFade
-          assert(std::get<0>(resultVector[5]) == 6.0f); // Check the sixth sample after crossFade
-          assert(std::get<0>(resultVector[6]) == 7.0f); // Check the seventh sample after crossFade
-          assert(std::get<0>(resultVector[7]) == 8.0f); // Check the eighth sample after crossFade
-          assert(std::get<0>(resultVector[8]) == 9.0f); // Check the ninth sample after crossFade
-          assert(std::get<0>(resultVector[9]) == 10.0f); // Check the tenth sample after crossFade
+          assert(resultVector.angle(0) == 1.0f); // Check the first sample after crossFade
+          assert(resultVector.angle(1) == 2.0f); // Check the second sample after crossFade
+          assert(resultVector.angle(2) == 3.0f); // Check the third sample after crossFade
+          assert(resultVector.angle(3) == 4.0f); // Check the fourth sample after crossFade
+          assert(resultVector.angle(4) == 5.0f); // Check the fifth sample after crossFade
+          assert(resultVector.angle(5) == 6.0f); // Check the sixth sample after crossFade
+          assert(resultVector.angle(6) == 7.0f); // Check the seventh sample after crossFade
+          assert(resultVector.angle(7) == 8.0f); // Check the eighth sample after crossFade
+          assert(resultVector.angle(8) == 9.0f); // Check the ninth sample after crossFade
+          assert(resultVector.angle(9) == 10.0f); // Check the tenth sample after crossFade
      }
 
+      void TimeSeriesTest::testResampleIncrementalDuplicates() {
+          // Sliding window like the inbound data of the predictor
+          RingTimeSeries ts(1000);
+          UniformTimeSeries incremental;
+
+          auto time = TimeSeries::Timestamp(std::chrono::seconds(0));
+          float angle = 0.0f;
+          for (int batch = 0; batch < 200; ++batch) {
+              // Every other batch starts with a sample that replaces the latest one
+              if (batch % 2 == 1)
+                  ts.add(angle + 5.0f, time);
+
+              // Irregular spacing, so there are interpolated samples before the replaced one
+              for (int i = 0; i < 7; ++i) {
+                  time += std::chrono::milliseconds(1 + (batch + i) % 4);
+                  angle = static_cast<float>((batch * 7 + i) % 50);
+                  ts.add(angle, time);
+              }
+              ts.dropBefore(time - std::chrono::milliseconds(300));
+
+              // Check the incremental result equals resampling the whole window
+              ts.resampleIncremental(incremental);
+              auto full = ts.resample();
+              assert(incremental.size() == full.size());
+              assert(incremental.start() == full.start());
+              for (size_t i = 0; i < full.size(); ++i) {
+                  assert(incremental.time(i) == full.time(i));
+                  assert(incremental.angle(i) == full.angle(i));
+              }
+          }
+     }
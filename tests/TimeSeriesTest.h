@@ -12,4 +12,5 @@ public:
     static void testCrossFadeOverlap();
     static void testCrossFadePartialOverlap();
     static void testCrossFadeNoOverlap();
+    static void testResampleIncrementalDuplicates();
 };